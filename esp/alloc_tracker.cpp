@@ -0,0 +1,106 @@
+#include "alloc_tracker.hpp"
+
+#ifdef CONFIG_ALLOC_TRACKING
+
+#ifdef ESP_PLATFORM
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// The heap hooks may be called while the flash cache is disabled
+#define ALLOC_HOOK_ATTR IRAM_ATTR
+#else
+#define ALLOC_HOOK_ATTR
+#endif
+
+using TaskId = const void *;
+
+#ifdef ESP_PLATFORM
+// Null before the scheduler started
+static ALLOC_HOOK_ATTR TaskId current_task() { return xTaskGetCurrentTaskHandle(); }
+#else
+static TaskId current_task() {
+    static thread_local const char marker = 0;
+    return &marker;
+}
+#endif
+
+// A scope while it's open. The counts are only touched by the task that opened it, so they need no atomics, which
+// keeps the hooks cheap and free of 64 bit atomics that would end up in library calls.
+struct OpenScope {
+    std::atomic<TaskId> owner{nullptr};
+    uint32_t allocations = 0;
+    uint32_t frees = 0;
+    uint32_t bytes = 0;
+};
+
+static std::array<OpenScope, AllocScopes::COUNT> open_scopes;
+// Lets the hooks return right away while no refresh is running, i.e. most of the time
+static std::atomic<uint32_t> open_scope_count{0};
+
+namespace AllocTracker {
+ALLOC_HOOK_ATTR void recordAllocation(size_t size) {
+    if (open_scope_count.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    const auto task = current_task();
+    if (task == nullptr) {
+        return;
+    }
+    for (auto &open : open_scopes) {
+        if (open.owner.load(std::memory_order_relaxed) == task) {
+            open.allocations++;
+            open.bytes += static_cast<uint32_t>(size);
+        }
+    }
+}
+
+ALLOC_HOOK_ATTR void recordFree() {
+    if (open_scope_count.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    const auto task = current_task();
+    if (task == nullptr) {
+        return;
+    }
+    for (auto &open : open_scopes) {
+        if (open.owner.load(std::memory_order_relaxed) == task) {
+            open.frees++;
+        }
+    }
+}
+
+Scope::Scope(AllocScope scope) : scope(scope) {
+    auto &open = open_scopes[AllocScopes::index(scope)];
+    open.allocations = 0;
+    open.frees = 0;
+    open.bytes = 0;
+    open.owner = current_task();
+    open_scope_count++;
+}
+
+Scope::~Scope() {
+    auto &open = open_scopes[AllocScopes::index(scope)];
+    open.owner = nullptr;
+    open_scope_count--;
+    alloc_scope_stats[AllocScopes::index(scope)].record(open.allocations, open.frees, open.bytes);
+}
+} // namespace AllocTracker
+
+#ifdef ESP_PLATFORM
+// Called by the heap for every allocation and free with `CONFIG_HEAP_USE_HOOKS`, which `CONFIG_ALLOC_TRACKING` selects
+extern "C" ALLOC_HOOK_ATTR void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t) {
+    if (ptr != nullptr) {
+        AllocTracker::recordAllocation(size);
+    }
+}
+
+extern "C" ALLOC_HOOK_ATTR void esp_heap_trace_free_hook(void *ptr) {
+    if (ptr != nullptr) {
+        AllocTracker::recordFree();
+    }
+}
+#endif
+
+#endif
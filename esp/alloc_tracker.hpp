@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef ESP_PLATFORM
+#include <sdkconfig.h>
+#endif
+
+// Parts of a departures refresh cycle whose heap allocations are counted if `CONFIG_ALLOC_TRACKING` is set
+enum class AllocScope : uint8_t {
+    // `BvgApiClient::fetchAndParseTrips`, building the URL and parsing included. Also counts what ESP-IDF's HTTP client
+    // and mbedTLS allocate for every request, so unlike `Filter` and `Apply` it never gets to zero.
+    Fetch,
+    // Filtering the trips and building the board
+    Filter,
+    // `DeparturesScreen::applyBoard` in the LVGL task, LVGL objects included
+    Apply,
+    // All of `fetch_and_process_trips`, i.e. `Fetch` and `Filter` and whatever happens in between. Like `Fetch`, it
+    // never gets to zero.
+    Cycle,
+};
+
+namespace AllocScopes {
+// Indexed by `AllocScope`
+inline constexpr const char *NAMES[] = {"fetch", "filter", "apply", "cycle"};
+inline constexpr size_t COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+constexpr size_t index(AllocScope scope) { return static_cast<size_t>(scope); }
+
+constexpr const char *name(AllocScope scope) { return NAMES[index(scope)]; }
+
+static_assert(COUNT == index(AllocScope::Cycle) + 1, "NAMES must have one entry per AllocScope");
+} // namespace AllocScopes
+
+// What a scope allocated, written when it ends by the task that ran it, read by the HTTP server
+struct AllocScopeStats {
+    std::atomic<uint32_t> runs{0};
+    // Runs that didn't allocate anything. Every `Filter` run should be, and every `Apply` run whose departures didn't
+    // change.
+    std::atomic<uint32_t> allocation_free_runs{0};
+    // Of the most recent run
+    std::atomic<uint32_t> last_allocations{0};
+    std::atomic<uint32_t> last_frees{0};
+    std::atomic<uint32_t> last_bytes{0};
+    // The most allocations of a single run
+    std::atomic<uint32_t> max_allocations{0};
+    // Over all runs
+    std::atomic<uint64_t> total_allocations{0};
+    std::atomic<uint64_t> total_bytes{0};
+
+    void record(uint32_t allocations, uint32_t frees, uint32_t bytes) {
+        runs++;
+        if (allocations == 0) {
+            allocation_free_runs++;
+        }
+        last_allocations = allocations;
+        last_frees = frees;
+        last_bytes = bytes;
+        if (allocations > max_allocations) {
+            max_allocations = allocations;
+        }
+        total_allocations += allocations;
+        total_bytes += bytes;
+    }
+};
+
+#ifdef CONFIG_ALLOC_TRACKING
+inline std::array<AllocScopeStats, AllocScopes::COUNT> alloc_scope_stats;
+
+namespace AllocTracker {
+// Called for every allocation and free, by whichever task makes it. Both are counted for all scopes that this task
+// has open, so a scope includes the scopes nested in it. A free counts for the scope that frees, not the one that
+// allocated; the size of a freed block isn't known.
+void recordAllocation(size_t size);
+void recordFree();
+
+// Counts what the current task allocates from its construction until it goes out of scope. Only one task may have a
+// given scope open at a time.
+class Scope {
+  public:
+    explicit Scope(AllocScope scope);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    AllocScope scope;
+};
+} // namespace AllocTracker
+
+#else
+// Compiles to nothing, so that callers don't need any `#ifdef`s
+namespace AllocTracker {
+class Scope {
+  public:
+    explicit Scope(AllocScope) {}
+};
+} // namespace AllocTracker
+#endif
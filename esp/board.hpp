@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "hash.hpp"
+#include "product.hpp"
+#include "triple_buffer.hpp"
+
+// A departure as it ends up on the board. Texts are copied into fixed buffers, so a published board doesn't
+// reference anything owned by the task that built it.
+struct BoardRow {
+    // `Hash::fnv1a` of the full trip id, rows are told apart by this
+    uint64_t trip_hash;
+    char line[16];
+    char direction[64];
+    std::chrono::system_clock::time_point departure_time;
+    Product product;
+    bool is_cancelled;
+};
+
+// Filtered and sorted departures to be shown, built by the refresher and applied by the UI
+struct Board {
+    static const constexpr size_t MAX_ROWS = 20;
+
+    std::array<BoardRow, MAX_ROWS> rows;
+    size_t row_count = 0;
+    // Rows leaving sooner than this are dropped once their time comes
+    std::chrono::seconds min_time_to_departure{0};
+    std::chrono::system_clock::time_point updated_at;
+    // `Settings::version` the board was built from, see `DeparturesScreen::dropBoardsBefore`
+    uint32_t settings_version = 0;
+
+    void clear() { row_count = 0; }
+
+    // Returns false if the board is full. Texts that don't fit are truncated.
+    // Rows are told apart by their trip id, a trip that is on the board already is skipped.
+    bool addRow(std::string_view trip_id, std::string_view line, std::string_view direction,
+                std::chrono::system_clock::time_point departure_time, Product product, bool is_cancelled) {
+        return addRow(Hash::fnv1a(trip_id), line, direction, departure_time, product, is_cancelled);
+    }
+
+    // Same as above, for a trip id that was hashed already, e.g. one restored from a snapshot
+    bool addRow(uint64_t trip_hash, std::string_view line, std::string_view direction,
+                std::chrono::system_clock::time_point departure_time, Product product, bool is_cancelled) {
+        if (row_count == MAX_ROWS) {
+            return false;
+        }
+        if (findRow(trip_hash) != nullptr) {
+            return true;
+        }
+
+        auto &row = rows[row_count++];
+        row.trip_hash = trip_hash;
+        copy(row.line, line);
+        copy(row.direction, direction);
+        row.departure_time = departure_time;
+        row.product = product;
+        row.is_cancelled = is_cancelled;
+        return true;
+    }
+
+    const BoardRow *findRow(uint64_t trip_hash) const {
+        const auto end = rows.begin() + row_count;
+        const auto row = std::find_if(rows.begin(), end,
+                                      [&](const BoardRow &candidate) { return candidate.trip_hash == trip_hash; });
+        return row == end ? nullptr : &*row;
+    }
+
+    // Keeps the order of the other rows
+    void removeRow(uint64_t trip_hash) {
+        if (const auto *row = findRow(trip_hash)) {
+            const auto index = static_cast<size_t>(row - rows.data());
+            std::move(rows.begin() + index + 1, rows.begin() + row_count, rows.begin() + index);
+            row_count--;
+        }
+    }
+
+    void sortByDepartureTime() {
+        std::stable_sort(rows.begin(), rows.begin() + row_count,
+                         [](const BoardRow &a, const BoardRow &b) { return a.departure_time < b.departure_time; });
+    }
+
+  private:
+    template <size_t N> static void copy(char (&destination)[N], std::string_view source) {
+        const auto length = std::min(source.size(), N - 1);
+        std::memcpy(destination, source.data(), length);
+        destination[length] = '\0';
+    }
+};
+
+// Refresher task -> LVGL task
+inline TripleBuffer<Board> board_buffer;
@@ -0,0 +1,84 @@
+#include <cstring>
+
+#include "board_diff.hpp"
+
+static const constexpr size_t NOT_FOUND = SIZE_MAX;
+
+void BoardDiff::compute(const Board &previous, const Board &next) {
+    operation_count = 0;
+    kind_counts.fill(0);
+
+    // Position of each next row on the previous board. Boards hold a couple dozen rows at most, so comparing every
+    // pair of trip hashes is cheaper than a lookup table.
+    std::array<size_t, Board::MAX_ROWS> previous_index;
+    std::array<bool, Board::MAX_ROWS> kept{};
+    for (size_t i = 0; i < next.row_count; i++) {
+        previous_index[i] = NOT_FOUND;
+        for (size_t j = 0; j < previous.row_count; j++) {
+            if (!kept[j] && next.rows[i].trip_hash == previous.rows[j].trip_hash) {
+                previous_index[i] = j;
+                kept[j] = true;
+                break;
+            }
+        }
+    }
+
+    for (size_t j = 0; j < previous.row_count; j++) {
+        if (!kept[j]) {
+            add(BoardOperation::Kind::Remove, j);
+        }
+    }
+
+    for (size_t i = 0; i < next.row_count; i++) {
+        if (previous_index[i] != NOT_FOUND && !sameContent(previous.rows[previous_index[i]], next.rows[i])) {
+            add(BoardOperation::Kind::Update, i);
+        }
+    }
+
+    // Longest increasing subsequence of the previous positions of the kept rows, those don't have to move.
+    // Quadratic, but at most `MAX_ROWS` squared steps.
+    std::array<size_t, Board::MAX_ROWS> length;
+    std::array<size_t, Board::MAX_ROWS> predecessor;
+    size_t last = NOT_FOUND;
+    for (size_t i = 0; i < next.row_count; i++) {
+        if (previous_index[i] == NOT_FOUND) {
+            continue;
+        }
+        length[i] = 1;
+        predecessor[i] = NOT_FOUND;
+        for (size_t k = 0; k < i; k++) {
+            if (previous_index[k] != NOT_FOUND && previous_index[k] < previous_index[i] && length[k] + 1 > length[i]) {
+                length[i] = length[k] + 1;
+                predecessor[i] = k;
+            }
+        }
+        if (last == NOT_FOUND || length[i] > length[last]) {
+            last = i;
+        }
+    }
+
+    std::array<bool, Board::MAX_ROWS> stays{};
+    for (size_t i = last; i != NOT_FOUND; i = predecessor[i]) {
+        stays[i] = true;
+    }
+
+    // Back to front, so that the row each one is put in front of is in its final place already
+    for (size_t i = next.row_count; i-- > 0;) {
+        if (stays[i]) {
+            continue;
+        }
+        const auto before = i + 1 < next.row_count ? i + 1 : BoardOperation::END;
+        add(previous_index[i] == NOT_FOUND ? BoardOperation::Kind::Insert : BoardOperation::Kind::Move, i, before);
+    }
+}
+
+void BoardDiff::add(BoardOperation::Kind kind, size_t row, size_t before) {
+    operations[operation_count++] = {
+        .kind = kind, .row = static_cast<uint8_t>(row), .before = static_cast<uint8_t>(before)};
+    kind_counts[static_cast<size_t>(kind)]++;
+}
+
+bool BoardDiff::sameContent(const BoardRow &a, const BoardRow &b) {
+    return a.departure_time == b.departure_time && a.product == b.product && a.is_cancelled == b.is_cancelled &&
+           std::strcmp(a.line, b.line) == 0 && std::strcmp(a.direction, b.direction) == 0;
+}
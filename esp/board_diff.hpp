@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "board.hpp"
+
+// A single change to the rows on screen, see `BoardDiff`
+struct BoardOperation {
+    enum class Kind : uint8_t {
+        // Delete the row `row` of the previous board
+        Remove,
+        // Change the texts, time or product of the row `row` of the next board, which is on screen already
+        Update,
+        // Create the row `row` of the next board and put it right before `before`
+        Insert,
+        // Put the existing row `row` of the next board right before `before`
+        Move,
+    };
+
+    // Stands for "at the end of the list" in `before`
+    static const constexpr uint8_t END = UINT8_MAX;
+
+    Kind kind;
+    uint8_t row;
+    // Row of the next board, only for `Insert` and `Move`
+    uint8_t before;
+};
+
+// Minimal list of operations turning the rows of one board into the rows of the next one, matched by trip id.
+// Rows that keep their relative order (the longest increasing subsequence of their previous positions) stay where
+// they are, only the others are moved.
+//
+// The operations must be applied in order: first all removals, then all updates, then insertions and moves. The
+// latter are sorted from the last row to the first, so that the row named in `before` is always in its final place.
+class BoardDiff {
+  public:
+    // Every previous row is either removed or kept, every kept row updated and moved at most once, every other
+    // next row inserted
+    static const constexpr size_t MAX_OPERATIONS = 2 * Board::MAX_ROWS;
+
+    void compute(const Board &previous, const Board &next);
+
+    const BoardOperation *begin() const { return operations.data(); }
+    const BoardOperation *end() const { return operations.data() + operation_count; }
+    size_t size() const { return operation_count; }
+    size_t count(BoardOperation::Kind kind) const { return kind_counts[static_cast<size_t>(kind)]; }
+
+  private:
+    std::array<BoardOperation, MAX_OPERATIONS> operations;
+    size_t operation_count = 0;
+    std::array<size_t, 4> kind_counts{};
+
+    void add(BoardOperation::Kind kind, size_t row, size_t before = BoardOperation::END);
+    static bool sameContent(const BoardRow &a, const BoardRow &b);
+};
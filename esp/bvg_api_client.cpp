@@ -1,23 +1,18 @@
 #include <chrono>
+#include <cstring>
 #include <ctime>
 #include <esp_http_client.h>
 #include <esp_log.h>
-#include <map>
 #include <string>
-#include <vector>
+#include <strings.h>
 
+#include "alloc_tracker.hpp"
 #include "bvg_api_client.hpp"
 #include "nvs_engine.hpp"
-#include "time.hpp"
+#include "refresh_stats.hpp"
 
 static const char *TAG = "BvgApiClient";
 
-// 23052 bytes (22.5 KB) is the max observed size of a response with maxResults=20
-static const constexpr size_t HTTP_CLIENT_BUFFER_SIZE = 30 * 1024;
-static char http_client_buffer[HTTP_CLIENT_BUFFER_SIZE];
-
-const std::vector<std::string> ALL_PRODUCTS = {"suburban", "subway", "tram", "bus", "ferry", "express", "regional"};
-
 BvgApiClient::BvgApiClient() { initClient(); }
 
 void BvgApiClient::initClient() {
@@ -49,25 +44,46 @@ void BvgApiClient::resetConnection() {
 
 esp_err_t BvgApiClient::http_event_handler(esp_http_client_event_t *evt) {
     switch (evt->event_id) {
-    case HTTP_EVENT_ON_DATA:
+    case HTTP_EVENT_ON_CONNECTED:
+        LatencyProbes::record(RefreshStage::Connect, request_start);
+        break;
+
+    case HTTP_EVENT_HEADER_SENT:
+        headers_sent = LatencyProbes::now();
+        break;
+
+    case HTTP_EVENT_ON_HEADER:
+        if (!received_header) {
+            received_header = true;
+            LatencyProbes::record(RefreshStage::FirstByte, headers_sent);
+            first_header = LatencyProbes::now();
+        }
+        if (strcasecmp(evt->header_key, "ETag") == 0) {
+            strlcpy(this->received_etag, evt->header_value, sizeof(this->received_etag));
+        } else if (strcasecmp(evt->header_key, "Last-Modified") == 0) {
+            strlcpy(this->received_last_modified, evt->header_value, sizeof(this->received_last_modified));
+        }
+        break;
+
+    case HTTP_EVENT_ON_DATA: {
         ESP_LOGD(TAG, "HTTP_EVENT_ON_DATA, data_len=%d", evt->data_len);
-        ESP_LOGD(TAG, "Current buffer_pos: %d", buffer_pos);
+        refresh_stats.bytes_received += evt->data_len;
 
-        if (this->buffer_pos + evt->data_len >= HTTP_CLIENT_BUFFER_SIZE) {
-            ESP_LOGE(TAG, "Would overflow buffer, bailing out");
-            return ESP_FAIL;
+        // Bodies of redirects and error responses are not departures, don't feed them to the parser
+        if (esp_http_client_get_status_code(evt->client) != 200) {
+            break;
         }
-        memcpy(http_client_buffer + buffer_pos, evt->data, evt->data_len);
-        this->buffer_pos += evt->data_len;
+        const auto parse_start = LatencyProbes::now();
+        this->parser.feed(static_cast<const char *>(evt->data), evt->data_len);
+        parse_time.add(parse_start);
         break;
+    }
 
     case HTTP_EVENT_ON_FINISH:
         ESP_LOGD(TAG, "HTTP_EVENT_ON_FINISH");
-        this->buffer_pos = 0;
         break;
     case HTTP_EVENT_DISCONNECTED:
         ESP_LOGD(TAG, "HTTP_EVENT_DISCONNECTED");
-        this->buffer_pos = 0;
         break;
     default:
         break;
@@ -76,49 +92,72 @@ esp_err_t BvgApiClient::http_event_handler(esp_http_client_event_t *evt) {
     return ESP_OK;
 }
 
-std::string BvgApiClient::buildURL(const std::string &stationId, const std::vector<std::string> &enabledProducts,
-                                   int maxResults) {
-    std::map<std::string, std::string> queryParams = {
-        {"results", std::to_string(maxResults)},
-        {"pretty", "false"},
-        {"remarks", "false"},
-        // TODO Extract to constant
-        {"duration", std::to_string(60)},
-    };
-    for (const auto &product : ALL_PRODUCTS) {
-        queryParams[product] = "false";
-    }
-    for (const auto &product : enabledProducts) {
-        queryParams[product] = "true";
+std::string BvgApiClient::buildURL(const std::string &stationId, ProductMask enabledProducts, int maxResults) {
+    // Long enough for every parameter, so that appending never reallocates
+    std::string url;
+    url.reserve(256);
+
+    url += "https://v6.bvg.transport.rest/stops/";
+    // TODO URLEncode / escape? We don't really need it
+    url += stationId;
+    url += "/departures?results=";
+    url += std::to_string(maxResults);
+    // TODO Extract to constant
+    url += "&duration=60&pretty=false&remarks=false";
+
+    for (size_t i = 0; i < Products::COUNT; i++) {
+        const auto product = Products::fromIndex(i);
+        url += '&';
+        url += Products::name(product);
+        url += Products::contains(enabledProducts, product) ? "=true" : "=false";
     }
 
-    std::ostringstream url;
-
-    url << "https://v6.bvg.transport.rest/stops/" << stationId << "/departures?";
+    return url;
+}
 
-    for (auto entry = queryParams.begin(); entry != queryParams.end(); ++entry) {
-        if (entry != queryParams.begin()) {
-            url << "&";
+void BvgApiClient::setUrl(const Settings &settings) {
+    // The URL only depends on the settings, so it's rebuilt only after they changed
+    if (url.empty() || settings.version != url_settings_version) {
+        url_settings_version = settings.version;
+        const auto &station = *settings.current_station;
+        auto new_url = buildURL(station.id, station.enabled_products, settings.max_departure_count);
+        if (new_url != url) {
+            // Validators and departures of another query are meaningless for this one
+            url = std::move(new_url);
+            etag[0] = '\0';
+            last_modified[0] = '\0';
+            parser.forgetPrevious();
         }
+    }
+    esp_http_client_set_url(client, url.c_str());
+}
 
-        // TODO URLEncode / escape? We don't really need it
-        url << entry->first << "=" << entry->second;
+void BvgApiClient::setValidatorHeaders() {
+    if (etag[0] != '\0') {
+        esp_http_client_set_header(client, "If-None-Match", etag);
+    } else {
+        esp_http_client_delete_header(client, "If-None-Match");
     }
 
-    return url.str();
-}
+    if (last_modified[0] != '\0') {
+        esp_http_client_set_header(client, "If-Modified-Since", last_modified);
+    } else {
+        esp_http_client_delete_header(client, "If-Modified-Since");
+    }
 
-void BvgApiClient::setUrl(const std::string &stationId, const std::vector<std::string> &enabledProducts,
-                          int maxResults) {
-    auto url = buildURL(stationId, enabledProducts, maxResults);
-    esp_http_client_set_url(client, url.c_str());
+    received_etag[0] = '\0';
+    received_last_modified[0] = '\0';
 }
 
-// TODO The params are only passed to setUrl(), maybe we can call that directly and remove the params?
-// Or better, call `setUrl` in the settings HTTP post handler
-std::vector<Trip> BvgApiClient::fetchAndParseTrips(const std::string &stationId,
-                                                   const std::vector<std::string> &enabledProducts, int maxResults) {
-    this->setUrl(stationId, enabledProducts, maxResults);
+FetchResult BvgApiClient::fetchAndParseTrips(const Settings &settings) {
+    const AllocTracker::Scope fetch_allocations(AllocScope::Fetch);
+    this->setUrl(settings);
+    this->setValidatorHeaders();
+    // Departures are parsed while they're downloaded, see `http_event_handler`
+    this->parser.reset(settings.max_departure_count);
+    received_header = false;
+    parse_time.reset();
+    request_start = LatencyProbes::now();
     auto err = esp_http_client_perform(client);
 
     if (err != ESP_OK) {
@@ -130,54 +169,47 @@ std::vector<Trip> BvgApiClient::fetchAndParseTrips(const std::string &stationId,
             ESP_LOGW(TAG, "Too many consecutive failures (%d), resetting connection", consecutive_failures);
             resetConnection();
         }
-        return {};
+        return {.status = FetchStatus::Failed, .trips = {}};
     }
 
     consecutive_failures = 0;
-
-    JsonDocument filter;
-    filter["departures"][0]["tripId"] = true;
-    filter["departures"][0]["direction"] = true;
-    filter["departures"][0]["line"]["name"] = true;
-    filter["departures"][0]["line"]["product"] = true;
-    filter["departures"][0]["when"] = true;
-    filter["departures"][0]["plannedWhen"] = true;
-
-    JsonDocument doc;
-    // TODO It would be cool to use a std::istream here, would probably save memory too.
-    auto deserializationError = deserializeJson(doc, http_client_buffer, DeserializationOption::Filter(filter));
-    if (deserializationError) {
-        ESP_LOGE(TAG, "Failed to parse JSON: %s", deserializationError.c_str());
-        return {};
+    if (received_header) {
+        LatencyProbes::record(RefreshStage::Download, first_header);
+        parse_time.record(RefreshStage::Parse);
     }
 
-    JsonArray departures = doc["departures"];
-    auto departure_count = departures.size();
-    ESP_LOGD(TAG, "Got %d departures", departure_count);
-
-    std::vector<Trip> trips;
-    trips.reserve(departure_count);
+    const auto status_code = esp_http_client_get_status_code(client);
+    if (status_code == 304) {
+        ESP_LOGD(TAG, "Departures not modified");
+        refresh_stats.not_modified_responses++;
+        if (!this->parser.hasPrevious()) {
+            // Nothing to show for the validators we sent, ask for the full response next time
+            ESP_LOGW(TAG, "Departures not modified, but there are no previous ones");
+            etag[0] = '\0';
+            last_modified[0] = '\0';
+            return {.status = FetchStatus::Failed, .trips = {}};
+        }
+        this->parser.restorePrevious();
+        return {.status = FetchStatus::Unchanged, .trips = this->parser.getTrips()};
+    }
 
-    for (auto departure : departures) {
-        const char *tripId = departure["tripId"];
-        const char *direction = departure["direction"];
-        const char *line = departure["line"]["name"];
-        const char *product = departure["line"]["product"];
+    if (!this->parser.foundDepartures()) {
+        ESP_LOGE(TAG, "No departures found in response (HTTP status %d)", status_code);
+        return {.status = FetchStatus::Failed, .trips = {}};
+    }
 
-        const auto departure_time =
-            departure["when"].isNull()
-                ? std::nullopt
-                : std::make_optional(Time::iSO8601StringToTimePoint(static_cast<const char *>(departure["when"])));
+    // A truncated body must neither be shown nor be vouched for by its validators, the server would answer the next
+    // request with 304 and an older batch would come back
+    if (!this->parser.complete()) {
+        ESP_LOGE(TAG, "Response ended before the end of the departures");
+        return {.status = FetchStatus::Failed, .trips = {}};
+    }
 
-        const auto planned_time = Time::iSO8601StringToTimePoint(static_cast<const char *>(departure["plannedWhen"]));
+    strlcpy(etag, received_etag, sizeof(etag));
+    strlcpy(last_modified, received_last_modified, sizeof(last_modified));
 
-        trips.push_back({.tripId = tripId,
-                         .departureTime = departure_time,
-                         .plannedTime = planned_time,
-                         .directionName = direction,
-                         .lineName = line,
-                         .productType = product});
-    }
+    const auto &trips = this->parser.getTrips();
+    ESP_LOGD(TAG, "Got %d departures", static_cast<int>(trips.size()));
 
-    return trips;
+    return {.status = this->parser.unchanged() ? FetchStatus::Unchanged : FetchStatus::Updated, .trips = trips};
 }
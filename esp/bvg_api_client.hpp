@@ -1,39 +1,61 @@
 #pragma once
 
-#include <ArduinoJson.h>
-#include <chrono>
-#include <ctime>
 #include <esp_http_client.h>
-#include <optional>
+#include <span>
 #include <string>
-#include <vector>
-
-struct Trip {
-    const std::string tripId;
-    const std::optional<std::chrono::system_clock::time_point> departureTime;
-    const std::chrono::system_clock::time_point plannedTime;
-    const std::string directionName;
-    const std::string lineName;
-    const std::string productType;
+
+#include "departures_stream_parser.hpp"
+#include "latency_probes.hpp"
+#include "product.hpp"
+#include "settings.hpp"
+#include "trip.hpp"
+
+enum class FetchStatus : uint8_t {
+    Failed,
+    // Same departures as the previous successful fetch, either via `304 Not Modified` or an identical body
+    Unchanged,
+    Updated,
+};
+
+struct FetchResult {
+    FetchStatus status;
+    // Owned by the client's parser, valid until the next fetch
+    std::span<const Trip> trips;
 };
 
 class BvgApiClient {
   public:
     BvgApiClient();
     ~BvgApiClient();
-    std::vector<Trip> fetchAndParseTrips(const std::string &stationId, const std::vector<std::string> &enabledProducts,
-                                         int maxResults);
-    static std::string buildURL(const std::string &stationId, const std::vector<std::string> &enabledProducts,
-                                int maxResults);
+    // `settings` must have a current station
+    FetchResult fetchAndParseTrips(const Settings &settings);
+    static std::string buildURL(const std::string &stationId, ProductMask enabledProducts, int maxResults);
 
   private:
     esp_http_client_handle_t client;
     esp_err_t http_event_handler(esp_http_client_event_t *evt);
-    void setUrl(const std::string &stationId, const std::vector<std::string> &enabledProducts, int maxResults);
+    void setUrl(const Settings &settings);
     void resetConnection();
     void initClient();
-    int buffer_pos = 0;
+    void setValidatorHeaders();
+    DeparturesStreamParser parser;
     int consecutive_failures = 0;
 
+    // Validators of the last successful response, sent back as `If-None-Match`/`If-Modified-Since`
+    std::string url;
+    // `Settings::version` the URL was built from
+    uint32_t url_settings_version = 0;
+    char etag[96] = "";
+    char last_modified[40] = "";
+    char received_etag[96] = "";
+    char received_last_modified[40] = "";
+
+    // Timing of the request in flight, see `RefreshStage`
+    LatencyProbes::Timestamp request_start;
+    LatencyProbes::Timestamp headers_sent;
+    LatencyProbes::Timestamp first_header;
+    bool received_header = false;
+    LatencyProbes::Accumulator parse_time;
+
     static constexpr const int MAX_CONSECUTIVE_FAILURES = 3;
 };
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstring>
+#include <esp_check.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include <mutex>
+#include <sdkconfig.h>
+
+#include "cpu_sampler.hpp"
+
+#ifdef CONFIG_CPU_SAMPLER
+
+static const char *TAG = "CpuSampler";
+
+static constexpr size_t CORE_COUNT = portNUM_PROCESSORS;
+static constexpr size_t HISTORY = CpuSampler::WINDOWS.back();
+// More than the app ever runs, FreeRTOS reports nothing if the array is too small
+static constexpr size_t MAX_TASKS = 32;
+
+static_assert(std::is_sorted(CpuSampler::WINDOWS.begin(), CpuSampler::WINDOWS.end()),
+              "The longest window must come last");
+
+using Counter = decltype(TaskStatus_t::ulRunTimeCounter);
+
+// Runtime in µs since the previous sample
+struct Sample {
+    uint32_t elapsed_us;
+    std::array<uint32_t, CORE_COUNT> idle_us;
+    std::array<uint32_t, CpuSampler::TRACKED_TASK_COUNT> task_us;
+};
+
+// Runtime counters as of the previous sample. The counters wrap around, which unsigned differences take care of.
+struct Counters {
+    Counter total;
+    std::array<Counter, CORE_COUNT> idle;
+    std::array<Counter, CpuSampler::TRACKED_TASK_COUNT> tasks;
+};
+
+// Only used by `take_sample`, which runs in the esp_timer task
+static std::array<TaskStatus_t, MAX_TASKS> task_states;
+static Counters previous;
+static bool has_previous = false;
+
+// Ring buffer of the last `HISTORY` samples, guarded by `samples_mutex`
+static std::array<Sample, HISTORY> samples;
+static size_t next_sample = 0;
+static size_t sample_count = 0;
+static std::mutex samples_mutex;
+
+static esp_timer_handle_t sample_timer = nullptr;
+
+static void take_sample(void *) {
+    Counter total = 0;
+    const auto task_count = uxTaskGetSystemState(task_states.data(), task_states.size(), &total);
+    if (task_count == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, not sampling", static_cast<int>(MAX_TASKS));
+        return;
+    }
+
+    // Tasks that aren't running keep their previous counter, i.e. count as having used nothing
+    Counters current = previous;
+    current.total = total;
+    for (size_t i = 0; i < task_count; i++) {
+        const auto &task = task_states[i];
+        for (size_t core = 0; core < CORE_COUNT; core++) {
+            if (task.xHandle == xTaskGetIdleTaskHandleForCore(static_cast<BaseType_t>(core))) {
+                current.idle[core] = task.ulRunTimeCounter;
+            }
+        }
+        for (size_t tracked = 0; tracked < CpuSampler::TRACKED_TASK_COUNT; tracked++) {
+            if (std::strcmp(task.pcTaskName, CpuSampler::TRACKED_TASKS[tracked].task_name) == 0) {
+                current.tasks[tracked] = task.ulRunTimeCounter;
+            }
+        }
+    }
+
+    if (has_previous) {
+        Sample sample{
+            .elapsed_us = static_cast<uint32_t>(current.total - previous.total), .idle_us = {}, .task_us = {}};
+        for (size_t core = 0; core < CORE_COUNT; core++) {
+            sample.idle_us[core] = static_cast<uint32_t>(current.idle[core] - previous.idle[core]);
+        }
+        for (size_t tracked = 0; tracked < CpuSampler::TRACKED_TASK_COUNT; tracked++) {
+            sample.task_us[tracked] = static_cast<uint32_t>(current.tasks[tracked] - previous.tasks[tracked]);
+        }
+
+        const std::lock_guard lock(samples_mutex);
+        samples[next_sample] = sample;
+        next_sample = (next_sample + 1) % HISTORY;
+        sample_count = std::min(sample_count + 1, HISTORY);
+    }
+    previous = current;
+    has_previous = true;
+}
+
+namespace CpuSampler {
+esp_err_t start() {
+    const esp_timer_create_args_t timer_args = {
+        .callback = take_sample,
+        .name = "cpu_sampler",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &sample_timer), TAG, "Failed to create the sampling timer");
+    return esp_timer_start_periodic(sample_timer,
+                                    std::chrono::duration_cast<std::chrono::microseconds>(SAMPLE_PERIOD).count());
+}
+
+Usage usage(uint32_t window) {
+    uint64_t elapsed_us = 0;
+    std::array<uint64_t, CORE_COUNT> idle_us{};
+    std::array<uint64_t, TRACKED_TASK_COUNT> task_us{};
+    Usage result{.samples = 0, .cores = {}, .tasks = {}};
+    {
+        const std::lock_guard lock(samples_mutex);
+        result.samples = static_cast<uint32_t>(std::min<size_t>(window, sample_count));
+        for (size_t i = 0; i < result.samples; i++) {
+            const auto &sample = samples[(next_sample + HISTORY - 1 - i) % HISTORY];
+            elapsed_us += sample.elapsed_us;
+            for (size_t core = 0; core < CORE_COUNT; core++) {
+                idle_us[core] += sample.idle_us[core];
+            }
+            for (size_t tracked = 0; tracked < TRACKED_TASK_COUNT; tracked++) {
+                task_us[tracked] += sample.task_us[tracked];
+            }
+        }
+    }
+
+    if (elapsed_us == 0) {
+        return result;
+    }
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        // The counters aren't read at exactly the same time, so idle can come out a bit above the elapsed time
+        const auto busy_us = elapsed_us - std::min(idle_us[core], elapsed_us);
+        result.cores[core] = 100.0f * static_cast<float>(busy_us) / static_cast<float>(elapsed_us);
+    }
+    for (size_t tracked = 0; tracked < TRACKED_TASK_COUNT; tracked++) {
+        result.tasks[tracked] = 100.0f * static_cast<float>(task_us[tracked]) / static_cast<float>(elapsed_us);
+    }
+    return result;
+}
+} // namespace CpuSampler
+#endif
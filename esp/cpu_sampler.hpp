@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+
+// Recent CPU usage, from the FreeRTOS runtime counters sampled in the background. Unlike the totals since boot in the
+// task list, this shows what e.g. a refresh cycle or scrolling costs right now.
+namespace CpuSampler {
+inline constexpr auto SAMPLE_PERIOD = std::chrono::seconds(1);
+// Usage is reported over each of these, in samples. The last one is how many samples are kept.
+inline constexpr std::array<uint32_t, 3> WINDOWS = {1, 10, 60};
+
+struct TrackedTask {
+    // As reported via `/api/sysinfo`
+    const char *key;
+    // As passed to `xTaskCreate`
+    const char *task_name;
+};
+
+// Tasks whose usage is reported on their own
+inline constexpr TrackedTask TRACKED_TASKS[] = {
+    {.key = "lvgl", .task_name = "taskLVGL"},
+    {.key = "httpd", .task_name = "httpd"},
+    {.key = "refresher", .task_name = "DeparturesRefresherTask"},
+    {.key = "wifi", .task_name = "wifi"},
+    {.key = "tcpip", .task_name = "tiT"},
+};
+inline constexpr size_t TRACKED_TASK_COUNT = sizeof(TRACKED_TASKS) / sizeof(TRACKED_TASKS[0]);
+
+struct Usage {
+    // Samples the usage was computed from, fewer than the window shortly after boot
+    uint32_t samples;
+    // Percent of the time each core wasn't idle
+    std::array<float, portNUM_PROCESSORS> cores;
+    // Percent of one core taken by each of `TRACKED_TASKS`
+    std::array<float, TRACKED_TASK_COUNT> tasks;
+};
+
+// Starts sampling every `SAMPLE_PERIOD`
+esp_err_t start();
+// Usage over the last `window` samples
+Usage usage(uint32_t window);
+} // namespace CpuSampler
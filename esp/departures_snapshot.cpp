@@ -0,0 +1,188 @@
+#include <cstring>
+#include <esp_log.h>
+
+#include "departures_snapshot.hpp"
+#include "nvs_engine.hpp"
+
+static const char *TAG = "DeparturesSnapshot";
+
+static const constexpr uint32_t MAGIC = 0x53445453; // "STDS"
+static const constexpr uint8_t VERSION = 2;
+static const constexpr char *NVS_KEY = "snapshot";
+
+// magic, version, entry count, minimum departure minutes, saved at
+static const constexpr size_t HEADER_SIZE = 4 + 1 + 1 + 1 + 8;
+// departure time, trip hash, product, flags, line/direction lengths
+static const constexpr size_t ENTRY_HEADER_SIZE = 8 + 8 + 1 + 1 + 2;
+
+static const constexpr uint8_t FLAG_CANCELLED = 1 << 0;
+
+namespace DeparturesSnapshot {
+namespace {
+int64_t toEpochSeconds(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point fromEpochSeconds(int64_t seconds) {
+    return std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+}
+
+template <typename T> void append(std::vector<uint8_t> &buffer, T value) {
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void appendString(std::vector<uint8_t> &buffer, const std::string &text) {
+    buffer.insert(buffer.end(), text.begin(), text.end());
+}
+
+class Reader {
+  public:
+    Reader(const uint8_t *data, size_t length) : data(data), remaining(length) {}
+
+    template <typename T> bool read(T &value) {
+        if (remaining < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        remaining -= sizeof(T);
+        return true;
+    }
+
+    bool readString(size_t length, std::string &text) {
+        if (remaining < length) {
+            return false;
+        }
+        text.assign(reinterpret_cast<const char *>(data), length);
+        data += length;
+        remaining -= length;
+        return true;
+    }
+
+  private:
+    const uint8_t *data;
+    size_t remaining;
+};
+} // namespace
+
+std::vector<uint8_t> encode(const Snapshot &snapshot) {
+    if (snapshot.entries.size() > UINT8_MAX) {
+        return {};
+    }
+
+    size_t size = HEADER_SIZE;
+    for (const auto &entry : snapshot.entries) {
+        if (entry.line.size() > UINT8_MAX || entry.direction.size() > UINT8_MAX) {
+            return {};
+        }
+        size += ENTRY_HEADER_SIZE + entry.line.size() + entry.direction.size();
+    }
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve(size);
+    append(buffer, MAGIC);
+    append(buffer, VERSION);
+    append(buffer, static_cast<uint8_t>(snapshot.entries.size()));
+    append(buffer, snapshot.min_departure_minutes);
+    append(buffer, toEpochSeconds(snapshot.saved_at));
+
+    for (const auto &entry : snapshot.entries) {
+        append(buffer, toEpochSeconds(entry.departure_time));
+        append(buffer, entry.trip_hash);
+        append(buffer, static_cast<uint8_t>(Products::index(entry.product)));
+        append(buffer, static_cast<uint8_t>(entry.is_cancelled ? FLAG_CANCELLED : 0));
+        append(buffer, static_cast<uint8_t>(entry.line.size()));
+        append(buffer, static_cast<uint8_t>(entry.direction.size()));
+        appendString(buffer, entry.line);
+        appendString(buffer, entry.direction);
+    }
+
+    return buffer;
+}
+
+std::optional<Snapshot> decode(const uint8_t *data, size_t length) {
+    Reader reader(data, length);
+
+    uint32_t magic;
+    uint8_t version, count;
+    int64_t saved_at;
+    Snapshot snapshot;
+    if (!reader.read(magic) || magic != MAGIC || !reader.read(version) || version != VERSION ||
+        !reader.read(count) || !reader.read(snapshot.min_departure_minutes) || !reader.read(saved_at)) {
+        return std::nullopt;
+    }
+    snapshot.saved_at = fromEpochSeconds(saved_at);
+
+    snapshot.entries.reserve(count);
+    for (uint8_t i = 0; i < count; i++) {
+        int64_t departure_time;
+        uint8_t product, flags, line_length, direction_length;
+        Entry entry;
+        if (!reader.read(departure_time) || !reader.read(entry.trip_hash) || !reader.read(product) ||
+            product >= Products::COUNT_WITH_UNKNOWN || !reader.read(flags) || !reader.read(line_length) ||
+            !reader.read(direction_length) || !reader.readString(line_length, entry.line) ||
+            !reader.readString(direction_length, entry.direction)) {
+            return std::nullopt;
+        }
+        entry.departure_time = fromEpochSeconds(departure_time);
+        entry.product = Products::fromIndex(product);
+        entry.is_cancelled = flags & FLAG_CANCELLED;
+        snapshot.entries.push_back(std::move(entry));
+    }
+
+    return snapshot;
+}
+
+esp_err_t save(const Snapshot &snapshot) {
+    const auto buffer = encode(snapshot);
+    if (buffer.empty()) {
+        ESP_LOGW(TAG, "Departures don't fit the snapshot format, not saving them");
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    NVSEngine nvs_engine("suntransit");
+    auto err = nvs_engine.setBlob(NVS_KEY, buffer.data(), buffer.size());
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save snapshot: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    ESP_LOGD(TAG, "Saved %d departures in %d bytes", static_cast<int>(snapshot.entries.size()),
+             static_cast<int>(buffer.size()));
+    return ESP_OK;
+}
+
+const char *loadResultName(LoadResult result) {
+    switch (result) {
+    case LoadResult::Shown:
+        return "shown";
+    case LoadResult::Missing:
+        return "missing";
+    case LoadResult::ClockNotSet:
+        return "clock_not_set";
+    case LoadResult::TooOld:
+        return "too_old";
+    }
+    return "unknown";
+}
+
+std::optional<Snapshot> load() {
+    NVSEngine nvs_engine("suntransit");
+    std::vector<uint8_t> buffer;
+    auto err = nvs_engine.readBlob(NVS_KEY, &buffer);
+    if (err != ESP_OK) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            ESP_LOGE(TAG, "Failed to read snapshot: %s", esp_err_to_name(err));
+        }
+        return std::nullopt;
+    }
+
+    auto snapshot = decode(buffer.data(), buffer.size());
+    if (!snapshot) {
+        ESP_LOGW(TAG, "Stored snapshot is invalid, ignoring it");
+    }
+    return snapshot;
+}
+} // namespace DeparturesSnapshot
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <esp_err.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "product.hpp"
+
+// Last departures that made it onto the screen, persisted to NVS so that they can be shown right after boot and
+// while fetching fails. The countdowns are projected forward from the stored departure times.
+namespace DeparturesSnapshot {
+struct Entry {
+    // `BoardRow::trip_hash`, the full trip id doesn't need to be kept around
+    uint64_t trip_hash;
+    std::string line;
+    std::string direction;
+    std::chrono::system_clock::time_point departure_time;
+    Product product;
+    bool is_cancelled;
+};
+
+struct Snapshot {
+    std::chrono::system_clock::time_point saved_at;
+    uint8_t min_departure_minutes;
+    std::vector<Entry> entries;
+};
+
+// Compact binary encoding: a fixed header, then per entry the departure time, trip hash, product, flags and the
+// two length-prefixed strings. Times are stored with second precision.
+// Returns an empty vector if the snapshot doesn't fit the format.
+std::vector<uint8_t> encode(const Snapshot &snapshot);
+std::optional<Snapshot> decode(const uint8_t *data, size_t length);
+
+esp_err_t save(const Snapshot &snapshot);
+std::optional<Snapshot> load();
+
+// Whether a snapshot could be shown
+enum class LoadResult : uint8_t {
+    Shown,
+    // Nothing saved yet, or the stored snapshot is invalid
+    Missing,
+    // The clock is behind the time the snapshot was saved at, which is always the case after a cold power-up until
+    // SNTP synced. The age of the snapshot is unknown then, so only software resets are covered.
+    ClockNotSet,
+    // Every departure in it has left
+    TooOld,
+};
+
+const char *loadResultName(LoadResult result);
+
+// Of the attempt at boot, exposed via `/api/sysinfo`
+inline std::atomic<LoadResult> boot_load_result{LoadResult::Missing};
+} // namespace DeparturesSnapshot
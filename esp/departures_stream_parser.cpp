@@ -0,0 +1,249 @@
+#include <esp_log.h>
+#include <string_view>
+
+#include "departures_stream_parser.hpp"
+#include "hash.hpp"
+#include "string_pool.hpp"
+#include "time.hpp"
+
+static const char *TAG = "DeparturesStreamParser";
+
+// A single departure is ~1.2 KB with `remarks=false`, this leaves plenty of headroom.
+// Departures that don't fit are skipped, the rest of the response is still parsed.
+static const constexpr size_t ITEM_BUFFER_SIZE = 4 * 1024;
+static char item_buffer[ITEM_BUFFER_SIZE];
+
+// Depth at which the elements of the `departures` array live: `{"departures": [{...}]}`
+static const constexpr int DEPARTURE_ITEM_DEPTH = 2;
+
+DeparturesStreamParser::DeparturesStreamParser() {
+    filter["tripId"] = true;
+    filter["direction"] = true;
+    filter["line"]["name"] = true;
+    filter["line"]["product"] = true;
+    filter["when"] = true;
+    filter["plannedWhen"] = true;
+}
+
+void DeparturesStreamParser::reset(size_t maxTrips) {
+    // Only a complete response is worth comparing against, partial ones come from failed requests
+    if (state == State::Done) {
+        previous_trips.swap(trips);
+        previous_item_hashes.swap(item_hashes);
+        previous_departures_hash = departures_hash;
+        has_previous = true;
+    }
+
+    // The previous trips may still be reused, their strings must survive this cycle
+    string_pool.nextGeneration();
+    touchStrings(previous_trips);
+
+    state = State::SeekingDepartures;
+    depth = 0;
+    in_string = false;
+    escaped = false;
+    key_length = 0;
+    collecting_key = false;
+    capturing_item = false;
+    item_length = 0;
+    item_overflow = false;
+    max_trips = maxTrips;
+    trips.clear();
+    trips.reserve(maxTrips);
+    item_hashes.clear();
+    item_hashes.reserve(maxTrips);
+    departures_hash = Hash::FNV1A_OFFSET_BASIS;
+}
+
+bool DeparturesStreamParser::unchanged() const {
+    return has_previous && state == State::Done && departures_hash == previous_departures_hash &&
+           trips.size() == previous_trips.size();
+}
+
+void DeparturesStreamParser::restorePrevious() {
+    if (!has_previous) {
+        return;
+    }
+
+    // The current response is empty, nothing is lost by swapping, and the next `reset` swaps them back
+    trips.swap(previous_trips);
+    item_hashes.swap(previous_item_hashes);
+    departures_hash = previous_departures_hash;
+    state = State::Done;
+}
+
+void DeparturesStreamParser::forgetPrevious() {
+    has_previous = false;
+    previous_trips.clear();
+    previous_item_hashes.clear();
+    previous_departures_hash = 0;
+}
+
+void DeparturesStreamParser::touchStrings(const std::vector<Trip> &trips) {
+    for (const auto &trip : trips) {
+        string_pool.touch(trip.lineName);
+        string_pool.touch(trip.directionName);
+    }
+}
+
+void DeparturesStreamParser::feed(const char *data, size_t length) {
+    for (size_t i = 0; i < length && state != State::Done; i++) {
+        const char c = data[i];
+
+        if (state == State::InDepartures) {
+            departures_hash = Hash::fnv1a(std::string_view(&c, 1), departures_hash);
+        }
+
+        if (capturing_item) {
+            if (item_length < ITEM_BUFFER_SIZE) {
+                item_buffer[item_length++] = c;
+            } else {
+                item_overflow = true;
+            }
+        }
+
+        if (in_string) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                in_string = false;
+                collecting_key = false;
+                continue;
+            }
+
+            if (collecting_key) {
+                if (key_length < sizeof(key)) {
+                    key[key_length++] = c;
+                } else {
+                    collecting_key = false;
+                }
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            in_string = true;
+            if (depth == 1) {
+                key_length = 0;
+                collecting_key = true;
+            }
+            break;
+        case '[':
+            if (state == State::SeekingDepartures && depth == 1 &&
+                std::string_view(key, key_length) == std::string_view("departures")) {
+                state = State::InDepartures;
+            }
+            depth++;
+            break;
+        case '{':
+            if (state == State::InDepartures && depth == DEPARTURE_ITEM_DEPTH) {
+                capturing_item = true;
+                item_overflow = false;
+                item_buffer[0] = c;
+                item_length = 1;
+            }
+            depth++;
+            break;
+        case '}':
+            depth--;
+            if (capturing_item && depth == DEPARTURE_ITEM_DEPTH) {
+                capturing_item = false;
+                finishItem();
+            }
+            break;
+        case ']':
+            depth--;
+            if (state == State::InDepartures && depth == 1) {
+                state = State::Done;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void DeparturesStreamParser::finishItem() {
+    if (item_overflow) {
+        ESP_LOGW(TAG, "Departure larger than %d bytes, skipping it", static_cast<int>(ITEM_BUFFER_SIZE));
+        return;
+    }
+
+    const auto item_hash = Hash::fnv1a(std::string_view(item_buffer, item_length));
+
+    const Trip *previous_trip = nullptr;
+    for (size_t i = 0; i < previous_item_hashes.size() && previous_trip == nullptr; i++) {
+        if (previous_item_hashes[i] == item_hash) {
+            previous_trip = &previous_trips[i];
+        }
+    }
+
+    if (previous_trip != nullptr) {
+        trips.push_back(*previous_trip);
+    } else if (!parseItem()) {
+        return;
+    }
+    item_hashes.push_back(item_hash);
+
+    if (trips.size() >= max_trips) {
+        ESP_LOGD(TAG, "Got %d departures, ignoring the rest of the response", static_cast<int>(trips.size()));
+        state = State::Done;
+    }
+}
+
+bool DeparturesStreamParser::parseItem() {
+    auto deserializationError = deserializeJson(doc, static_cast<const char *>(item_buffer), item_length,
+                                                DeserializationOption::Filter(filter));
+    if (deserializationError) {
+        ESP_LOGE(TAG, "Failed to parse departure JSON: %s", deserializationError.c_str());
+        return false;
+    }
+
+    const char *tripId = doc["tripId"];
+    const char *direction = doc["direction"];
+    const char *line = doc["line"]["name"];
+    const char *product = doc["line"]["product"];
+    const char *plannedWhen = doc["plannedWhen"];
+
+    if (tripId == nullptr || direction == nullptr || line == nullptr || product == nullptr ||
+        plannedWhen == nullptr) {
+        ESP_LOGW(TAG, "Departure is missing required fields, skipping it");
+        return false;
+    }
+
+    const auto departure_time =
+        doc["when"].isNull()
+            ? std::nullopt
+            : std::make_optional(Time::iSO8601StringToTimePoint(static_cast<const char *>(doc["when"])));
+
+    auto product_type = Products::fromName(product);
+    if (!product_type) {
+        // Shown with the fallback badge, a new product type must not empty the board
+        static bool logged_unknown_product = false;
+        if (!logged_unknown_product) {
+            logged_unknown_product = true;
+            ESP_LOGW(TAG, "Unknown product %s, showing it as unknown", product);
+        }
+        product_type = Product::Unknown;
+    }
+
+    const auto line_name = string_pool.intern(line);
+    const auto direction_name = string_pool.intern(direction);
+    if (!line_name || !direction_name) {
+        ESP_LOGW(TAG, "String pool is full, skipping departure");
+        return false;
+    }
+
+    const auto planned_time = Time::iSO8601StringToTimePoint(plannedWhen);
+
+    trips.push_back({.tripHash = Hash::fnv1a(tripId),
+                     .departureTime = departure_time,
+                     .plannedTime = planned_time,
+                     .directionName = *direction_name,
+                     .lineName = *line_name,
+                     .productType = *product_type});
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include <cstddef>
+#include <vector>
+
+#include "trip.hpp"
+
+// Incremental parser for the `/stops/:id/departures` response.
+// It scans the body chunk by chunk as it comes off the wire, buffers one element of the `departures` array at a time
+// and turns it into a `Trip` as soon as its closing brace arrives, so the whole body never has to be in memory.
+//
+// The raw bytes of every departure are hashed. Departures that are byte-for-byte identical to one of the previous
+// response are reused without running `deserializeJson`, and a hash of the whole `departures` array tells whether
+// anything changed at all.
+class DeparturesStreamParser {
+  public:
+    DeparturesStreamParser();
+    // Starts a new response. The result of the last complete one is kept around for comparison.
+    void reset(size_t maxTrips);
+    void feed(const char *data, size_t length);
+    bool foundDepartures() const { return state != State::SeekingDepartures; }
+    // True once the whole `departures` array, or `maxTrips` of it, has been parsed
+    bool complete() const { return state == State::Done; }
+    // True if there's a complete earlier response to fall back to on `304 Not Modified`
+    bool hasPrevious() const { return has_previous; }
+    // True if the response parsed since `reset` has exactly the same departures as the previous complete one
+    bool unchanged() const;
+    // Makes the previous complete response the current one again, for `304 Not Modified` responses
+    void restorePrevious();
+    // Drops the previous response, e.g. because the station changed
+    void forgetPrevious();
+    const std::vector<Trip> &getTrips() const { return trips; }
+
+  private:
+    enum class State : uint8_t { SeekingDepartures, InDepartures, Done };
+
+    void finishItem();
+    bool parseItem();
+    static void touchStrings(const std::vector<Trip> &trips);
+
+    State state = State::SeekingDepartures;
+    int depth = 0;
+    bool in_string = false;
+    bool escaped = false;
+
+    // Last string seen at the top level of the response, used to find the `departures` key
+    char key[16];
+    size_t key_length = 0;
+    bool collecting_key = false;
+
+    bool capturing_item = false;
+    size_t item_length = 0;
+    bool item_overflow = false;
+
+    size_t max_trips = 0;
+    std::vector<Trip> trips;
+    std::vector<uint64_t> item_hashes;
+    uint64_t departures_hash = 0;
+
+    bool has_previous = false;
+    std::vector<Trip> previous_trips;
+    std::vector<uint64_t> previous_item_hashes;
+    uint64_t previous_departures_hash = 0;
+
+    JsonDocument filter;
+    JsonDocument doc;
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Open-addressing hash table from 64-bit hashes to values, holding up to `Capacity` entries in a flat array.
+// It never allocates, and iterating touches a single contiguous block of memory. The keys are expected to be
+// hashes already (e.g. `Hash::fnv1a`), so they're only folded to pick a slot.
+//
+// Entries are removed with backward-shift deletion, which keeps probe sequences short without tombstones. This
+// moves other entries around though, so pointers into the table and iterators don't survive `erase`.
+template <typename Value, size_t Capacity> class FixedMap {
+  public:
+    struct Entry {
+        uint64_t key;
+        Value value;
+    };
+
+    // Returns nullptr if there's no entry for `key`
+    Value *find(uint64_t key) {
+        for (size_t slot = home(key);; slot = (slot + 1) & MASK) {
+            if (!used[slot]) {
+                return nullptr;
+            }
+            if (entries[slot].key == key) {
+                return &entries[slot].value;
+            }
+        }
+    }
+
+    // Returns the value for `key`, default-constructing it if needed. Returns nullptr if the table is full.
+    Value *insert(uint64_t key) {
+        for (size_t slot = home(key);; slot = (slot + 1) & MASK) {
+            if (!used[slot]) {
+                if (count == Capacity) {
+                    return nullptr;
+                }
+                used[slot] = true;
+                entries[slot] = {.key = key, .value = Value{}};
+                count++;
+                return &entries[slot].value;
+            }
+            if (entries[slot].key == key) {
+                return &entries[slot].value;
+            }
+        }
+    }
+
+    bool erase(uint64_t key) {
+        size_t slot = home(key);
+        while (true) {
+            if (!used[slot]) {
+                return false;
+            }
+            if (entries[slot].key == key) {
+                break;
+            }
+            slot = (slot + 1) & MASK;
+        }
+
+        // Pull later entries of the same probe sequence back into the hole, so that lookups don't stop early
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & MASK; used[next]; next = (next + 1) & MASK) {
+            const auto distance_from_home = (next - home(entries[next].key)) & MASK;
+            const auto distance_to_hole = (next - hole) & MASK;
+            if (distance_from_home >= distance_to_hole) {
+                entries[hole] = entries[next];
+                hole = next;
+            }
+        }
+        used[hole] = false;
+        count--;
+        return true;
+    }
+
+    // Erases every entry `predicate(entry)` returns true for
+    template <typename Predicate> size_t eraseIf(Predicate predicate) {
+        std::array<uint64_t, Capacity> keys;
+        size_t key_count = 0;
+        for (auto &entry : *this) {
+            if (predicate(entry)) {
+                keys[key_count++] = entry.key;
+            }
+        }
+        for (size_t i = 0; i < key_count; i++) {
+            erase(keys[i]);
+        }
+        return key_count;
+    }
+
+    void clear() {
+        used.fill(false);
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    template <typename Map, typename E> class Iterator {
+      public:
+        Iterator(Map *map, size_t slot) : map(map), slot(slot) { skipUnused(); }
+        E &operator*() const { return map->entries[slot]; }
+        E *operator->() const { return &map->entries[slot]; }
+        Iterator &operator++() {
+            slot++;
+            skipUnused();
+            return *this;
+        }
+        bool operator==(const Iterator &other) const { return slot == other.slot; }
+
+      private:
+        Map *map;
+        size_t slot;
+
+        void skipUnused() {
+            while (slot < SLOTS && !map->used[slot]) {
+                slot++;
+            }
+        }
+    };
+
+    auto begin() { return Iterator<FixedMap, Entry>(this, 0); }
+    auto end() { return Iterator<FixedMap, Entry>(this, SLOTS); }
+    auto begin() const { return Iterator<const FixedMap, const Entry>(this, 0); }
+    auto end() const { return Iterator<const FixedMap, const Entry>(this, SLOTS); }
+
+  private:
+    // At most about two thirds full
+    static const constexpr size_t SLOTS = std::bit_ceil(Capacity + Capacity / 2 + 1);
+    static const constexpr size_t MASK = SLOTS - 1;
+
+    std::array<Entry, SLOTS> entries{};
+    std::array<bool, SLOTS> used{};
+    size_t count = 0;
+
+    // The upper bits of a multiplicative hash mix best, also for keys that aren't great hashes themselves
+    static size_t home(uint64_t key) {
+        return static_cast<size_t>((key * 0x9e3779b97f4a7c15) >> (64 - std::countr_zero(SLOTS))) & MASK;
+    }
+};
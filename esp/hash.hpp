@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace Hash {
+static constexpr uint64_t FNV1A_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+static constexpr uint64_t FNV1A_PRIME = 0x100000001b3ULL;
+
+// 64-bit FNV-1a. Pass the previous result as `hash` to keep hashing a stream chunk by chunk.
+constexpr uint64_t fnv1a(std::string_view data, uint64_t hash = FNV1A_OFFSET_BASIS) {
+    for (const char c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+} // namespace Hash
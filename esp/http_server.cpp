@@ -1,4 +1,5 @@
 #include <ArduinoJson.h>
+#include <cstring>
 #include <esp_app_desc.h>
 #include <esp_chip_info.h>
 #include <esp_http_server.h>
@@ -14,10 +15,21 @@
 #include <string>
 #include <vector>
 
+#include "alloc_tracker.hpp"
+#include "board.hpp"
 #include "bvg_api_client.hpp"
+#include "cpu_sampler.hpp"
+#include "departures_snapshot.hpp"
 #include "http_server.hpp"
+#include "latency_probes.hpp"
 #include "nvs_engine.hpp"
+#include "prometheus_metrics.hpp"
+#include "refresh_stats.hpp"
+#include "refresher_events.hpp"
+#include "settings.hpp"
+#include "string_pool.hpp"
 #include "time.hpp"
+#include "ui.hpp"
 #include "utils.hpp"
 
 static const constexpr size_t FS_READ_BUFFER_SIZE = 30 * 1024;
@@ -32,6 +44,9 @@ static constexpr int MIN_DEPARTURE_MINUTES_MIN = 0;
 static constexpr int MIN_DEPARTURE_MINUTES_MAX = 30;
 static constexpr int MAX_DEPARTURE_COUNT_MIN = 1;
 static constexpr int MAX_DEPARTURE_COUNT_MAX = 20;
+static_assert(MAX_DEPARTURE_COUNT_MAX <= Board::MAX_ROWS, "Every departure must fit on the board");
+static constexpr int NIGHT_HOUR_MIN = 0;
+static constexpr int NIGHT_HOUR_MAX = 23;
 
 static esp_err_t init_fs(void) {
     esp_vfs_spiffs_conf_t conf = {
@@ -173,26 +188,102 @@ static esp_err_t api_get_sysinfo_handler(httpd_req_t *req) {
     // TODO The following line seems to be causing panics. Investigate.
     // memory["largest_free_heap_block"] = heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
 
-    auto debug = doc["debug"].to<JsonObject>();
-
-    // Read current settings to build the actual API URL
-    NVSEngine nvs_engine_for_debug("suntransit");
-    JsonDocument current_settings;
-    auto settings_err = nvs_engine_for_debug.readSettings(&current_settings);
-    if (settings_err == ESP_OK && !current_settings["currentStation"]["id"].isNull()) {
-        const char *station_id = current_settings["currentStation"]["id"];
-        int max_departure_count = current_settings["maxDepartureCount"];
-
-        // Build enabled products list
-        std::vector<std::string> enabled_products;
-        JsonArray products = current_settings["currentStation"]["enabledProducts"];
-        for (JsonVariant product : products) {
-            enabled_products.push_back(product.as<std::string>());
+    auto refresh = doc["refresh"].to<JsonObject>();
+    refresh["cycles"] = refresh_stats.cycles.load();
+    refresh["failed_cycles"] = refresh_stats.failed_cycles.load();
+    refresh["skipped_cycles"] = refresh_stats.skipped_cycles.load();
+    refresh["not_modified_responses"] = refresh_stats.not_modified_responses.load();
+    refresh["interval_ms"] = refresh_stats.interval_ms.load();
+    refresh["interval_reason"] = RefreshScheduler::reasonName(refresh_stats.interval_reason.load());
+    refresh["boot_snapshot"] = DeparturesSnapshot::loadResultName(DeparturesSnapshot::boot_load_result.load());
+
+    auto strings = doc["string_pool"].to<JsonObject>();
+    const auto lookups = string_pool.hits() + string_pool.misses();
+    strings["size"] = string_pool.size();
+    strings["capacity"] = StringPool::CAPACITY;
+    strings["hits"] = string_pool.hits();
+    strings["misses"] = string_pool.misses();
+    strings["evictions"] = string_pool.evictions();
+    strings["failures"] = string_pool.failures();
+    strings["hit_rate"] = lookups == 0 ? 0.0f : static_cast<float>(string_pool.hits()) / lookups;
+
+    auto rows = doc["row_pool"].to<JsonObject>();
+    rows["capacity"] = Board::MAX_ROWS;
+    rows["in_use"] = row_pool_stats.in_use.load();
+    rows["hits"] = row_pool_stats.hits.load();
+    rows["misses"] = row_pool_stats.misses.load();
+    rows["heap_bytes"] = row_pool_stats.heap_bytes.load();
+
+    auto render = doc["render"].to<JsonObject>();
+    render["last_refresh_invalidated_pixels"] = render_stats.last_refresh_invalidated_pixels.load();
+    render["screen_pixels"] = render_stats.screen_pixels.load();
+    render["frames"] = render_stats.frames.load();
+    render["last_frame_us"] = render_stats.last_frame_us.load();
+    render["last_full_redraw_us"] = render_stats.last_full_redraw_us.load();
+
+    auto scheduler = doc["scheduler"].to<JsonObject>();
+    auto jobs = scheduler["jobs"].to<JsonArray>();
+    for (size_t i = 0; i < Jobs::COUNT; i++) {
+        auto job = jobs.add<JsonObject>();
+        job["name"] = Jobs::NAMES[i];
+        job["runs"] = job_stats[i].runs.load();
+        job["last_lateness_us"] = job_stats[i].last_lateness_us.load();
+        job["max_lateness_us"] = job_stats[i].max_lateness_us.load();
+        job["jitter_us"] = job_stats[i].jitter_us.load();
+    }
+    auto ui_lock = scheduler["ui_lock"].to<JsonObject>();
+    ui_lock["acquisitions"] = ui_lock_stats.acquisitions.load();
+    ui_lock["slow_acquisitions"] = ui_lock_stats.slow_acquisitions.load();
+    ui_lock["total_wait_us"] = ui_lock_stats.total_wait_us.load();
+    ui_lock["max_wait_us"] = ui_lock_stats.max_wait_us.load();
+
+#ifdef CONFIG_CPU_SAMPLER
+    auto cpu = doc["cpu"].to<JsonArray>();
+    for (const auto window : CpuSampler::WINDOWS) {
+        const auto usage = CpuSampler::usage(window);
+        auto window_json = cpu.add<JsonObject>();
+        window_json["window_s"] = window * CpuSampler::SAMPLE_PERIOD.count();
+        window_json["samples"] = usage.samples;
+        auto cores = window_json["cores"].to<JsonArray>();
+        for (const auto core : usage.cores) {
+            cores.add(core);
+        }
+        auto tasks = window_json["tasks"].to<JsonObject>();
+        for (size_t i = 0; i < CpuSampler::TRACKED_TASK_COUNT; i++) {
+            tasks[CpuSampler::TRACKED_TASKS[i].key] = usage.tasks[i];
         }
+    }
+#else
+    doc["cpu"] = nullptr;
+#endif
 
+#ifdef CONFIG_ALLOC_TRACKING
+    auto allocations = doc["allocations"].to<JsonArray>();
+    for (size_t i = 0; i < AllocScopes::COUNT; i++) {
+        const auto &stats = alloc_scope_stats[i];
+        auto scope_json = allocations.add<JsonObject>();
+        scope_json["scope"] = AllocScopes::NAMES[i];
+        scope_json["runs"] = stats.runs.load();
+        scope_json["allocation_free_runs"] = stats.allocation_free_runs.load();
+        scope_json["last_allocations"] = stats.last_allocations.load();
+        scope_json["last_frees"] = stats.last_frees.load();
+        scope_json["last_bytes"] = stats.last_bytes.load();
+        scope_json["max_allocations"] = stats.max_allocations.load();
+        scope_json["total_allocations"] = stats.total_allocations.load();
+        scope_json["total_bytes"] = stats.total_bytes.load();
+    }
+#else
+    doc["allocations"] = nullptr;
+#endif
+
+    auto debug = doc["debug"].to<JsonObject>();
+
+    const auto settings = settings_cache.get();
+    if (settings.current_station) {
         // Build the actual URL that would be used
-        auto actual_url = BvgApiClient::buildURL(station_id, enabled_products, max_departure_count);
-        debug["bvg_api_url"] = actual_url;
+        const auto &station = *settings.current_station;
+        debug["bvg_api_url"] =
+            BvgApiClient::buildURL(station.id, station.enabled_products, settings.max_departure_count);
     } else {
         debug["bvg_api_url"] = nullptr;
     }
@@ -238,13 +329,14 @@ static esp_err_t api_get_sysinfo_handler(httpd_req_t *req) {
     doc["tasks"] = nullptr;
 #endif
 
-    char buffer[2048];
+    // The task list alone can get close to 2 KB, don't risk truncating the response with a fixed size buffer
+    std::string buffer;
     const auto bytesWritten = serializeJson(doc, buffer);
     if (bytesWritten == 0) {
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to serialize JSON");
         return ESP_FAIL;
     }
-    httpd_resp_send(req, buffer, bytesWritten);
+    httpd_resp_send(req, buffer.c_str(), bytesWritten);
     return ESP_OK;
 }
 
@@ -325,6 +417,24 @@ static esp_err_t api_set_settings_handler(httpd_req_t *req) {
         currentSettings["maxDepartureCount"] = maxDepartureCount;
     }
 
+    for (const char *key : {"nightStartHour", "nightEndHour"}) {
+        if (!settings_doc[key].is<JsonVariant>()) {
+            continue;
+        }
+        if (!settings_doc[key].is<int>()) {
+            auto error_msg = std::format("{} must be a number", key);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error_msg.c_str());
+            return ESP_FAIL;
+        }
+        int hour = settings_doc[key];
+        if (hour < NIGHT_HOUR_MIN || hour > NIGHT_HOUR_MAX) {
+            auto error_msg = std::format("{} must be between {} and {}", key, NIGHT_HOUR_MIN, NIGHT_HOUR_MAX);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error_msg.c_str());
+            return ESP_FAIL;
+        }
+        currentSettings[key] = hour;
+    }
+
     if (settings_doc["showCancelledDepartures"].is<JsonVariant>()) {
         if (!settings_doc["showCancelledDepartures"].is<bool>()) {
             httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "showCancelledDepartures must be a boolean");
@@ -341,11 +451,22 @@ static esp_err_t api_set_settings_handler(httpd_req_t *req) {
             httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "currentStation.id is required and must be a string");
             return ESP_FAIL;
         }
+        if (strlen(currentStation["id"].as<const char *>()) >= sizeof(StationSettings::id)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "currentStation.id is too long");
+            return ESP_FAIL;
+        }
         if (!currentStation["enabledProducts"].is<JsonArrayConst>()) {
             httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
                                 "currentStation.enabledProducts is required and must be an array");
             return ESP_FAIL;
         }
+        for (const auto product : currentStation["enabledProducts"].as<JsonArrayConst>()) {
+            if (!product.is<const char *>() || !Products::fromName(product.as<const char *>())) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                    "currentStation.enabledProducts must only contain known products");
+                return ESP_FAIL;
+            }
+        }
         currentSettings["currentStation"] = currentStation;
     }
 
@@ -354,6 +475,8 @@ static esp_err_t api_set_settings_handler(httpd_req_t *req) {
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to save settings");
         return ESP_FAIL;
     }
+    // Notifies the refresher and the UI
+    settings_cache.set(Settings::fromJson(currentSettings.as<JsonVariantConst>()));
 
     // TODO Reset scroll position when changing settings? For sure when changing station
     // Also reset it automatically after some time of no user interaction?
@@ -363,6 +486,53 @@ static esp_err_t api_set_settings_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+static esp_err_t api_refresh_handler(httpd_req_t *req) {
+    // Dropped only if the refresher is already backed up with events, the client can simply try again
+    RefresherEvents::post(RefresherEvent::ManualRefresh);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, "{}");
+    return ESP_OK;
+}
+
+#ifdef CONFIG_REFRESH_LATENCY_PROBES
+// How long each stage of the departures refresh takes, see `RefreshStage`. Bucket counts aren't cumulative, the
+// last one has no upper bound.
+static esp_err_t api_get_metrics_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "application/json");
+
+    JsonDocument doc;
+    auto bounds = doc["bucket_bounds_us"].to<JsonArray>();
+    for (const auto bound : LatencyHistogram::BOUNDS_US) {
+        bounds.add(bound);
+    }
+    doc["dropped_samples"] = dropped_latency_samples.load();
+
+    auto stages = doc["stages"].to<JsonArray>();
+    for (size_t i = 0; i < RefreshStages::COUNT; i++) {
+        const auto &histogram = refresh_latency[i];
+        auto stage = stages.add<JsonObject>();
+        stage["name"] = RefreshStages::NAMES[i];
+        stage["samples"] = histogram.samples.load();
+        stage["sum_us"] = histogram.sum_us.load();
+        stage["max_us"] = histogram.max_us.load();
+        auto buckets = stage["buckets"].to<JsonArray>();
+        for (const auto &count : histogram.buckets) {
+            buckets.add(count.load());
+        }
+    }
+
+    std::string buffer;
+    const auto bytesWritten = serializeJson(doc, buffer);
+    if (bytesWritten == 0) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to serialize JSON");
+        return ESP_FAIL;
+    }
+    httpd_resp_send(req, buffer.c_str(), bytesWritten);
+    return ESP_OK;
+}
+#endif
+
 httpd_handle_t setup_http_server() {
     init_fs();
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
@@ -395,6 +565,30 @@ httpd_handle_t setup_http_server() {
     };
     httpd_register_uri_handler(server, &api_set_settings_uri);
 
+    httpd_uri_t api_refresh_uri = {
+        .uri = "/api/refresh",
+        .method = HTTP_POST,
+        .handler = api_refresh_handler,
+    };
+    httpd_register_uri_handler(server, &api_refresh_uri);
+
+#ifdef CONFIG_REFRESH_LATENCY_PROBES
+    httpd_uri_t api_get_metrics_uri = {
+        .uri = "/api/metrics",
+        .method = HTTP_GET,
+        .handler = api_get_metrics_handler,
+    };
+    httpd_register_uri_handler(server, &api_get_metrics_uri);
+#endif
+
+    // Scraped by Prometheus, hence not under `/api`
+    httpd_uri_t metrics_uri = {
+        .uri = "/metrics",
+        .method = HTTP_GET,
+        .handler = PrometheusMetrics::send,
+    };
+    httpd_register_uri_handler(server, &metrics_uri);
+
     /* URI handler for getting web server files */
     httpd_uri_t common_get_uri = {.uri = "/*", .method = HTTP_GET, .handler = rest_common_get_handler};
     httpd_register_uri_handler(server, &common_get_uri);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+// Allocation-free parser for the timestamps returned by the BVG API, e.g. `2025-03-30T02:59:00+02:00`.
+// The UTC offset is taken from the string itself, so no timezone database lookups are needed and timestamps
+// around DST transitions come out right.
+namespace ISO8601 {
+using TimePoint = std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds>;
+
+namespace detail {
+constexpr bool parseNumber(std::string_view text, size_t position, size_t digits, int &result) {
+    result = 0;
+    for (size_t i = position; i < position + digits; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        result = result * 10 + (text[i] - '0');
+    }
+    return true;
+}
+} // namespace detail
+
+// Accepts `YYYY-MM-DDTHH:MM:SS` followed by either `Z` or a `+HH:MM`/`-HH:MM` offset.
+// Fractional seconds are not supported since the API doesn't return them.
+constexpr std::optional<TimePoint> parse(std::string_view text) {
+    // YYYY-MM-DDTHH:MM:SS
+    constexpr size_t DATE_TIME_LENGTH = 19;
+    if (text.size() < DATE_TIME_LENGTH + 1 || text[4] != '-' || text[7] != '-' || text[10] != 'T' ||
+        text[13] != ':' || text[16] != ':') {
+        return std::nullopt;
+    }
+
+    int year, month, day, hours, minutes, seconds;
+    if (!detail::parseNumber(text, 0, 4, year) || !detail::parseNumber(text, 5, 2, month) ||
+        !detail::parseNumber(text, 8, 2, day) || !detail::parseNumber(text, 11, 2, hours) ||
+        !detail::parseNumber(text, 14, 2, minutes) || !detail::parseNumber(text, 17, 2, seconds)) {
+        return std::nullopt;
+    }
+
+    const std::chrono::year_month_day date{std::chrono::year{year}, std::chrono::month{static_cast<unsigned>(month)},
+                                           std::chrono::day{static_cast<unsigned>(day)}};
+    // Leap seconds are not a thing in the API's timestamps, hence `seconds > 59`
+    if (!date.ok() || hours > 23 || minutes > 59 || seconds > 59) {
+        return std::nullopt;
+    }
+
+    std::chrono::seconds offset{0};
+    const auto zone = text.substr(DATE_TIME_LENGTH);
+    if (zone != "Z") {
+        // ±HH:MM
+        int offset_hours, offset_minutes;
+        if (zone.size() != 6 || (zone[0] != '+' && zone[0] != '-') || zone[3] != ':' ||
+            !detail::parseNumber(zone, 1, 2, offset_hours) || !detail::parseNumber(zone, 4, 2, offset_minutes) ||
+            offset_hours > 23 || offset_minutes > 59) {
+            return std::nullopt;
+        }
+        offset = std::chrono::hours{offset_hours} + std::chrono::minutes{offset_minutes};
+        if (zone[0] == '-') {
+            offset = -offset;
+        }
+    }
+
+    // The local time minus its offset is the UTC time
+    return std::chrono::sys_days{date} + std::chrono::hours{hours} + std::chrono::minutes{minutes} +
+           std::chrono::seconds{seconds} - offset;
+}
+
+static_assert(parse("1970-01-01T00:00:00Z")->time_since_epoch().count() == 0);
+static_assert(parse("2025-03-30T03:00:00+02:00") == parse("2025-03-30T01:00:00Z"));
+static_assert(!parse("2025-02-30T00:00:00+01:00").has_value());
+} // namespace ISO8601
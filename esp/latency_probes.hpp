@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef ESP_PLATFORM
+#include <esp_cpu.h>
+#include <esp_timer.h>
+#include <sdkconfig.h>
+#else
+#include <chrono>
+#endif
+
+// Stages of a departures refresh cycle, timed if `CONFIG_REFRESH_LATENCY_PROBES` is set
+enum class RefreshStage : uint8_t {
+    // DNS lookup, TCP connect and TLS handshake, only in cycles that had to open a new connection
+    Connect,
+    // From sending the request until the first response header arrived
+    FirstByte,
+    // From the first response header until the response is complete, `Parse` included
+    Download,
+    // Deserializing departures in the stream parser, summed up over the whole response
+    Parse,
+    // Filtering the trips and building the board
+    Filter,
+    // `DeparturesScreen::applyBoard` in the LVGL task
+    Apply,
+    // Rendering the frame that shows a new board and sending it to the LCD
+    Render,
+    // All of `fetch_and_process_trips`
+    Cycle,
+};
+
+namespace RefreshStages {
+// Indexed by `RefreshStage`
+inline constexpr const char *NAMES[] = {"connect", "first_byte", "download", "parse",
+                                        "filter",  "apply",      "render",   "cycle"};
+inline constexpr size_t COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+constexpr size_t index(RefreshStage stage) { return static_cast<size_t>(stage); }
+
+constexpr const char *name(RefreshStage stage) { return NAMES[index(stage)]; }
+
+static_assert(COUNT == index(RefreshStage::Cycle) + 1, "NAMES must have one entry per RefreshStage");
+} // namespace RefreshStages
+
+// Counts durations in fixed buckets, so that it never allocates and its size doesn't depend on the samples. Written
+// by a single task, read by the HTTP server.
+class LatencyHistogram {
+  public:
+    // Upper bounds of the buckets, inclusive. One more bucket takes everything slower.
+    static constexpr std::array<uint32_t, 15> BOUNDS_US = {100,    200,    500,     1000,    2000,
+                                                           5000,   10000,  20000,   50000,   100000,
+                                                           200000, 500000, 1000000, 2000000, 5000000};
+    static constexpr size_t BUCKET_COUNT = BOUNDS_US.size() + 1;
+
+    void record(uint32_t us) {
+        size_t bucket = 0;
+        while (bucket < BOUNDS_US.size() && us > BOUNDS_US[bucket]) {
+            bucket++;
+        }
+        buckets[bucket]++;
+        samples++;
+        sum_us += us;
+        if (us > max_us) {
+            max_us = us;
+        }
+    }
+
+    std::array<std::atomic<uint32_t>, BUCKET_COUNT> buckets{};
+    std::atomic<uint32_t> samples{0};
+    std::atomic<uint64_t> sum_us{0};
+    std::atomic<uint32_t> max_us{0};
+};
+
+#ifdef CONFIG_REFRESH_LATENCY_PROBES
+inline std::array<LatencyHistogram, RefreshStages::COUNT> refresh_latency;
+// Samples thrown away because the task moved to the other core in between, which has a cycle counter of its own
+inline std::atomic<uint32_t> dropped_latency_samples{0};
+
+namespace LatencyProbes {
+struct Timestamp {
+    uint32_t ticks;
+    // Microseconds since boot, for spans the cycle counter can't measure
+    int64_t us;
+    uint8_t core;
+};
+
+#ifdef ESP_PLATFORM
+// Assumes the CPU runs at its default frequency, i.e. that dynamic frequency scaling is off
+inline constexpr uint32_t TICKS_PER_US = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+
+inline Timestamp now() {
+    return {.ticks = esp_cpu_get_cycle_count(),
+            .us = esp_timer_get_time(),
+            .core = static_cast<uint8_t>(esp_cpu_get_core_id())};
+}
+#else
+inline constexpr uint32_t TICKS_PER_US = 1;
+
+inline Timestamp now() {
+    const auto since_epoch = std::chrono::steady_clock::now().time_since_epoch();
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(since_epoch).count();
+    return {.ticks = static_cast<uint32_t>(us), .us = us, .core = 0};
+}
+#endif
+
+inline void recordUs(RefreshStage stage, uint32_t us) { refresh_latency[RefreshStages::index(stage)].record(us); }
+
+// The 32 bit cycle counter wraps after about 17.9 s at 240 MHz, spans that might be that long are taken from the
+// 64 bit microsecond timer instead. A cycle can take longer than that: DNS, the 8 s connect timeout and the 8 s read
+// timeout add up.
+inline constexpr int64_t MAX_CYCLE_COUNTER_US = UINT32_MAX / TICKS_PER_US / 2;
+
+inline void record(RefreshStage stage, Timestamp start) {
+    const auto end = now();
+    const auto elapsed_us = end.us - start.us;
+    if (elapsed_us >= MAX_CYCLE_COUNTER_US) {
+        recordUs(stage, static_cast<uint32_t>(std::min<int64_t>(elapsed_us, UINT32_MAX)));
+        return;
+    }
+    if (end.core != start.core) {
+        dropped_latency_samples++;
+        return;
+    }
+    recordUs(stage, (end.ticks - start.ticks) / TICKS_PER_US);
+}
+
+// Sums up the time spent in a stage that's interrupted by others, e.g. parsing in between receiving chunks
+class Accumulator {
+  public:
+    void reset() {
+        ticks = 0;
+        valid = true;
+    }
+
+    void add(Timestamp start) {
+        const auto end = now();
+        valid = valid && end.core == start.core;
+        ticks += end.ticks - start.ticks;
+    }
+
+    void record(RefreshStage stage) const {
+        if (!valid) {
+            dropped_latency_samples++;
+            return;
+        }
+        recordUs(stage, ticks / TICKS_PER_US);
+    }
+
+  private:
+    uint32_t ticks = 0;
+    bool valid = true;
+};
+
+// Records the time from its construction until it goes out of scope
+class Scope {
+  public:
+    explicit Scope(RefreshStage stage) : stage(stage), start(now()) {}
+    ~Scope() { record(stage, start); }
+
+  private:
+    RefreshStage stage;
+    Timestamp start;
+};
+} // namespace LatencyProbes
+
+#else
+// Probes that compile to nothing, so that callers don't need any `#ifdef`s
+namespace LatencyProbes {
+struct Timestamp {};
+
+inline Timestamp now() { return {}; }
+inline void recordUs(RefreshStage, uint32_t) {}
+inline void record(RefreshStage, Timestamp) {}
+
+class Accumulator {
+  public:
+    void reset() {}
+    void add(Timestamp) {}
+    void record(RefreshStage) const {}
+};
+
+class Scope {
+  public:
+    explicit Scope(RefreshStage) {}
+};
+} // namespace LatencyProbes
+#endif
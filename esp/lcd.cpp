@@ -13,6 +13,7 @@
 #include <esp_lvgl_port.h>
 #include <freertos/task.h>
 #include <mutex>
+#include <sdkconfig.h>
 
 #include "lcd.hpp"
 
@@ -27,8 +28,12 @@
 #define LCD_ST7796_PARAM_BITS (8)
 #define LCD_ST7796_ENDIAN (LCD_RGB_ENDIAN_BGR)
 #define LCD_ST7796_BITS_PER_PIXEL (16)
+#ifdef CONFIG_LCD_DRAW_BUFFER_DOUBLE
+#define LCD_ST7796_DRAW_BUFF_DOUBLE (1)
+#else
 #define LCD_ST7796_DRAW_BUFF_DOUBLE (0)
-#define LCD_ST7796_DRAW_BUFF_HEIGHT (32)
+#endif
+#define LCD_ST7796_DRAW_BUFF_HEIGHT (CONFIG_LCD_DRAW_BUFFER_HEIGHT)
 #define LCD_ST7796_BL_ON_LEVEL (1)
 
 /* LCD pins */
@@ -196,9 +201,19 @@ static esp_err_t app_lvgl_init(void) {
             },
         .flags = {
             .buff_dma = true,
-            .swap_bytes = true,
+            // The panel wants big endian pixels, LVGL renders them that way right away, see below
+            .swap_bytes = false,
         }};
     lvgl_disp = lvgl_port_add_disp(&disp_cfg);
+    ESP_RETURN_ON_FALSE(lvgl_disp != NULL, ESP_FAIL, TAG, "Adding the LCD screen failed");
+
+    // Instead of having the port swap the bytes of every flushed pixel on the CPU. With a double buffer, the flush
+    // only queues the DMA transfer, and LVGL renders into the other buffer while it runs.
+    lvgl_port_lock(0);
+    lv_display_set_color_format(lvgl_disp, LV_COLOR_FORMAT_RGB565_SWAPPED);
+    lvgl_port_unlock();
+    ESP_LOGI(TAG, "Draw buffer: %d lines, %s", LCD_ST7796_DRAW_BUFF_HEIGHT,
+             LCD_ST7796_DRAW_BUFF_DOUBLE ? "double buffered" : "single buffered");
 
     /* Add touch input (for selected screen) */
     ESP_LOGD(TAG, "Add touch input");
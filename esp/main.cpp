@@ -1,3 +1,4 @@
+#include <atomic>
 #include <chrono>
 #include <esp_http_client.h>
 #include <esp_log.h>
@@ -8,16 +9,26 @@
 #include <freertos/event_groups.h>
 #include <lwip/apps/netbiosns.h>
 #include <mdns.h>
+#include <span>
 #include <sys/param.h>
 #include <thread>
-#include <unordered_set>
 #include <wifi_provisioning/manager.h>
 #include <wifi_provisioning/scheme_softap.h>
 
+#include "alloc_tracker.hpp"
+#include "board.hpp"
 #include "bvg_api_client.hpp"
+#include "cpu_sampler.hpp"
+#include "departures_snapshot.hpp"
 #include "http_server.hpp"
+#include "latency_probes.hpp"
 #include "lcd.hpp"
 #include "nvs_engine.hpp"
+#include "refresh_scheduler.hpp"
+#include "refresh_stats.hpp"
+#include "refresher_events.hpp"
+#include "settings.hpp"
+#include "string_pool.hpp"
 #include "time.hpp"
 #include "ui.hpp"
 #include "utils.hpp"
@@ -33,8 +44,14 @@ static esp_timer_handle_t wifi_timeout_timer = nullptr;
 
 using namespace std::chrono_literals;
 
-static constexpr auto DEPARTURES_REFRESH_PERIOD = 10s;
-static constexpr auto LAST_UPDATED_REFRESH_PERIOD = 500ms;
+// Limits flash wear, the countdowns are projected from the departure times anyway
+static constexpr auto SNAPSHOT_SAVE_PERIOD = 5min;
+// The API returns the departures of the next hour, after that every departure in a snapshot has left
+static constexpr auto SNAPSHOT_MAX_AGE = 1h;
+static constexpr int SNAPSHOT_AFTER_FAILED_FETCHES = 3;
+
+// Set while the departures screen was shown from the snapshot before Wi-Fi came up
+static bool showing_boot_snapshot = false;
 
 void reset_wifi_and_reboot() {
     ESP_LOGI(TAG, "WiFi reset requested by user");
@@ -98,6 +115,7 @@ static void provisioning_event_handler(void *arg, esp_event_base_t event_base, i
             break;
         case WIFI_EVENT_STA_DISCONNECTED:
             ESP_LOGI(TAG, "Disconnected. Connecting to the AP again...");
+            RefresherEvents::post(RefresherEvent::NetworkDown);
             esp_wifi_connect();
             break;
         case WIFI_EVENT_AP_STACONNECTED:
@@ -118,6 +136,8 @@ static void provisioning_event_handler(void *arg, esp_event_base_t event_base, i
             esp_timer_stop(wifi_timeout_timer);
         }
 
+        RefresherEvents::post(RefresherEvent::NetworkUp);
+
         /* Signal main application to continue execution */
         xEventGroupSetBits(wifi_event_group, WIFI_CONNECTED_EVENT);
     }
@@ -173,146 +193,370 @@ void init_network_wifi_and_wifimanager() {
     ESP_ERROR_CHECK(wifi_prov_mgr_init(config));
 }
 
-QueueHandle_t departuresRefreshQueue = xQueueCreate(1, sizeof(uint8_t));
+// Filter settings the departures on screen were last applied with
+struct AppliedFilters {
+    int minDepartureMinutes;
+    bool showCancelledDepartures;
 
-void fetch_and_process_trips(BvgApiClient &apiClient) {
-    ESP_LOGD(TAG, "Fetching trips...");
-    NVSEngine nvs_engine("suntransit");
+    bool operator==(const AppliedFilters &other) const = default;
+};
+static std::optional<AppliedFilters> last_applied_filters;
 
-    JsonDocument settingsDoc;
-    auto err = nvs_engine.readSettings(&settingsDoc);
-    if (err) {
-        ESP_LOGE(TAG, "Failed to read settings from NVS");
-        const ui_lock_guard lock;
-        departures_screen.showStationNotFoundError();
+// Departures last applied to the screen that still have to be written to NVS. Kept as a fixed-size `Board`, the
+// snapshot with its strings is only built when a write is due.
+static Board pending_snapshot_board;
+static bool snapshot_pending = false;
+static std::optional<std::chrono::system_clock::time_point> last_snapshot_save;
+
+static void save_snapshot_if_due() {
+    const auto now = Time::timePointNow();
+    if (!snapshot_pending || (last_snapshot_save && now - *last_snapshot_save < SNAPSHOT_SAVE_PERIOD)) {
         return;
     }
 
-    if (settingsDoc["currentStation"].isNull()) {
+    const auto &board = pending_snapshot_board;
+    DeparturesSnapshot::Snapshot snapshot{
+        .saved_at = board.updated_at,
+        .min_departure_minutes = static_cast<uint8_t>(
+            std::chrono::duration_cast<std::chrono::minutes>(board.min_time_to_departure).count()),
+        .entries = {},
+    };
+    snapshot.entries.reserve(board.row_count);
+    for (size_t i = 0; i < board.row_count; i++) {
+        const auto &row = board.rows[i];
+        snapshot.entries.push_back({.trip_hash = row.trip_hash,
+                                    .line = row.line,
+                                    .direction = row.direction,
+                                    .departure_time = row.departure_time,
+                                    .product = row.product,
+                                    .is_cancelled = row.is_cancelled});
+    }
+
+    if (DeparturesSnapshot::save(snapshot) == ESP_OK) {
+        last_snapshot_save = now;
+    }
+    snapshot_pending = false;
+}
+
+// Loads the persisted departures, if they are recent enough to still contain departures that haven't left.
+// An implausible clock, e.g. right after power-up before SNTP synced, also makes the snapshot unusable.
+static std::optional<DeparturesSnapshot::Snapshot> load_usable_snapshot(DeparturesSnapshot::LoadResult &result) {
+    using DeparturesSnapshot::LoadResult;
+    auto snapshot = DeparturesSnapshot::load();
+    if (!snapshot) {
+        result = LoadResult::Missing;
+        return std::nullopt;
+    }
+
+    const auto now = Time::timePointNow();
+    if (now < snapshot->saved_at) {
+        ESP_LOGI(TAG, "The clock isn't set yet, the age of the snapshot is unknown, not using it");
+        result = LoadResult::ClockNotSet;
+        return std::nullopt;
+    }
+    if (now - snapshot->saved_at > SNAPSHOT_MAX_AGE) {
+        ESP_LOGD(TAG, "Snapshot is too old, not using it");
+        result = LoadResult::TooOld;
+        return std::nullopt;
+    }
+    result = LoadResult::Shown;
+    return snapshot;
+}
+
+// Puts the snapshot on the board, projected to the current time
+static void show_snapshot(const DeparturesSnapshot::Snapshot &snapshot) {
+    const auto now = Time::timePointNow();
+    auto &board = board_buffer.back();
+    board.clear();
+    board.updated_at = snapshot.saved_at;
+    // Only shown while nothing newer is on screen, so it must not be dropped by `dropBoardsBefore`
+    board.settings_version = settings_cache.version();
+    board.min_time_to_departure = std::chrono::seconds(snapshot.min_departure_minutes * 60);
+    for (const auto &entry : snapshot.entries) {
+        if (entry.departure_time - board.min_time_to_departure < now) {
+            continue;
+        }
+        board.addRow(entry.trip_hash, entry.line, entry.direction, entry.departure_time, entry.product,
+                     entry.is_cancelled);
+    }
+    // Saved in order already
+    board_buffer.publish();
+
+    ESP_LOGI(TAG, "Showing %d departures from a snapshot taken %d s ago", static_cast<int>(snapshot.entries.size()),
+             static_cast<int>(std::chrono::duration_cast<std::chrono::seconds>(now - snapshot.saved_at).count()));
+}
+
+// Time until the earliest trip that hasn't left yet, cancelled trips don't count
+static std::optional<std::chrono::seconds> time_to_next_departure(std::span<const Trip> trips,
+                                                                  std::chrono::system_clock::time_point now) {
+    std::optional<std::chrono::seconds> result;
+    for (const auto &trip : trips) {
+        if (!trip.departureTime.has_value() || *trip.departureTime < now) {
+            continue;
+        }
+        const auto time_to_departure = std::chrono::duration_cast<std::chrono::seconds>(*trip.departureTime - now);
+        if (!result || time_to_departure < *result) {
+            result = time_to_departure;
+        }
+    }
+    return result;
+}
+
+RefreshOutcome fetch_and_process_trips(BvgApiClient &apiClient) {
+    ESP_LOGD(TAG, "Fetching trips...");
+    refresh_stats.cycles++;
+    const LatencyProbes::Scope cycle_probe(RefreshStage::Cycle);
+    const AllocTracker::Scope cycle_allocations(AllocScope::Cycle);
+
+    const auto settings = settings_cache.get();
+    RefreshOutcome outcome{.night_schedule = {.start_hour = settings.night_start_hour,
+                                              .end_hour = settings.night_end_hour}};
+
+    if (!settings.current_station) {
         ESP_LOGD(TAG, "No current station configured");
         // TODO Do not repeat this all the time, save the status and update the screen only on change
         const ui_lock_guard lock;
         departures_screen.showStationNotFoundError();
-        return;
+        return outcome;
     }
 
-    // TODO When the station is configured initially, the "station not found" message
-    // remains until the first reboot. Fix
-    auto currentStationDoc = settingsDoc["currentStation"];
-    int minDepartureMinutes = settingsDoc["minDepartureMinutes"];
-    int maxDepartureCount = settingsDoc["maxDepartureCount"];
-    bool showCancelledDepartures = settingsDoc["showCancelledDepartures"];
+    const int minDepartureMinutes = settings.min_departure_minutes;
+    const bool showCancelledDepartures = settings.show_cancelled_departures;
 
     ESP_LOGD(TAG, "Minimum departure minutes filter: %d", minDepartureMinutes);
-    ESP_LOGD(TAG, "Maximum departure count: %d", maxDepartureCount);
+    ESP_LOGD(TAG, "Maximum departure count: %d", settings.max_departure_count);
     ESP_LOGD(TAG, "Show cancelled departures: %s", showCancelledDepartures ? "true" : "false");
 
-    auto enabledProductsJsonArray = currentStationDoc["enabledProducts"].as<JsonArrayConst>();
-    std::vector<std::string> enabledProducts;
-    for (auto enabledProduct : enabledProductsJsonArray) {
-        enabledProducts.push_back(enabledProduct.as<std::string>());
-    }
-    auto trips = apiClient.fetchAndParseTrips(currentStationDoc["id"], enabledProducts, maxDepartureCount);
+    const auto result = apiClient.fetchAndParseTrips(settings);
+    const auto trips = result.trips;
     ESP_LOGD(TAG, "Fetched and parsed %d trips", trips.size());
+    outcome.status = result.status;
+
+    if (result.status == FetchStatus::Failed) {
+        refresh_stats.failed_cycles++;
+        return outcome;
+    }
 
     if (trips.empty()) {
         ESP_LOGE(TAG, "No trips found!");
-        return;
+        return outcome;
     }
 
-    {
-        // Update departures screen with tripId-based management for efficient updates
-        const ui_lock_guard lock;
-        const auto now = Time::timePointNow();
+    const auto now = Time::timePointNow();
+    outcome.next_departure = time_to_next_departure(trips, now);
+
+    // The countdowns are kept up to date by `refreshCountdowns`, which also drops departed trips. If the departures
+    // are the same as last time and the filters didn't change there's nothing to do.
+    const AppliedFilters filters{.minDepartureMinutes = minDepartureMinutes,
+                                 .showCancelledDepartures = showCancelledDepartures};
+    if (result.status == FetchStatus::Unchanged && last_applied_filters == filters) {
+        ESP_LOGD(TAG, "Departures unchanged, skipping update");
+        refresh_stats.skipped_cycles++;
+        departures_screen.updateLastUpdatedTime();
+        return outcome;
+    }
 
-        // Keep track of current tripIds to remove stale items
-        std::unordered_set<std::string> currentTripIds;
+    // Build the board off the UI lock, the LVGL task picks it up and applies it
+    const auto filter_start = LatencyProbes::now();
+    auto &board = board_buffer.back();
+    {
+        const AllocTracker::Scope filter_allocations(AllocScope::Filter);
+        board.clear();
+        board.updated_at = now;
+        board.settings_version = settings.version;
+        board.min_time_to_departure = std::chrono::seconds(minDepartureMinutes * 60);
 
-        for (auto trip : trips) {
+        for (const auto &trip : trips) {
             // For cancelled trips (when=null), use plannedTime; for active trips, use departureTime
             const bool isCancelled = !trip.departureTime.has_value();
             const auto timeToDisplay = isCancelled ? trip.plannedTime : trip.departureTime.value();
 
             const auto timeToDeparture = std::chrono::duration_cast<std::chrono::seconds>(timeToDisplay - now);
 
-            if (minDepartureMinutes > 0) {
-                const auto minDepartureSeconds = std::chrono::seconds(minDepartureMinutes * 60);
-                if (timeToDeparture < minDepartureSeconds) {
-                    ESP_LOGD(TAG, "Filtering out trip %s (departure in %ld seconds, minimum is %ld seconds)",
-                             trip.tripId.c_str(), timeToDeparture.count(), minDepartureSeconds.count());
-                    continue;
-                }
+            // Same rule as in `refreshCountdowns`, which also drops trips that have already left
+            if (timeToDeparture < board.min_time_to_departure) {
+                ESP_LOGD(TAG, "Filtering out trip %016llx (departure in %ld seconds, minimum is %ld seconds)",
+                         static_cast<unsigned long long>(trip.tripHash), timeToDeparture.count(),
+                         board.min_time_to_departure.count());
+                continue;
             }
 
             if (!showCancelledDepartures && isCancelled) {
-                ESP_LOGD(TAG, "Filtering out cancelled trip %s", trip.tripId.c_str());
+                ESP_LOGD(TAG, "Filtering out cancelled trip %016llx", static_cast<unsigned long long>(trip.tripHash));
                 continue;
             }
 
-            currentTripIds.insert(trip.tripId);
-            departures_screen.updateDepartureItem(trip.tripId, trip.lineName, trip.directionName, timeToDeparture,
-                                                  trip.productType, isCancelled);
-        }
-
-        // Remove items that are no longer in the current data
-        std::vector<std::string> itemsToRemove;
-        for (const auto &[tripId, item] : departures_screen.getDepartureItems()) {
-            if (currentTripIds.find(tripId) == currentTripIds.end()) {
-                itemsToRemove.push_back(tripId);
+            if (!board.addRow(trip.tripHash, string_pool.get(trip.lineName), string_pool.get(trip.directionName),
+                              timeToDisplay, trip.productType, isCancelled)) {
+                break;
             }
         }
-        for (const auto &tripId : itemsToRemove) {
-            departures_screen.removeDepartureItem(tripId);
-        }
+        board.sortByDepartureTime();
+        LatencyProbes::record(RefreshStage::Filter, filter_start);
+    }
 
-        departures_screen.reorderByDepartureTime();
+    pending_snapshot_board = board;
+    snapshot_pending = true;
 
-        departures_screen.updateLastUpdatedTime();
-    }
+    board_buffer.publish();
+    last_applied_filters = filters;
     ESP_LOGD(TAG, "Done processing trips");
+    return outcome;
 }
 
-void DeparturesRefresherTask(void *pvParameter) {
-    uint8_t message;
+// One-shot, re-armed by the refresher task with the interval picked by the `RefreshScheduler`
+esp_timer_handle_t departuresRefreshTimerHandle = nullptr;
+// When the timer is due to fire, for the lateness of `Job::DeparturesRefresh`
+static std::atomic<std::chrono::steady_clock::time_point> refresh_due;
+
+static void schedule_next_refresh(std::chrono::milliseconds interval) {
+    // Still armed if the refresh was requested early, e.g. because the settings changed
+    esp_timer_stop(departuresRefreshTimerHandle);
+    refresh_due = std::chrono::steady_clock::now() + interval;
+    auto err = esp_timer_start_once(departuresRefreshTimerHandle,
+                                    std::chrono::duration_cast<std::chrono::microseconds>(interval).count());
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to schedule the next refresh: %s", esp_err_to_name(err));
+    }
+}
+
+// Fetches the departures and arms the timer for the next fetch
+static void refresh_departures(BvgApiClient &apiClient, RefreshScheduler &scheduler, int &failed_fetches) {
+    const auto outcome = fetch_and_process_trips(apiClient);
+    if (outcome.status == FetchStatus::Failed) {
+        failed_fetches++;
+        // E.g. after rebooting during a network outage, the screen would stay empty otherwise
+        bool screen_empty;
+        {
+            const ui_lock_guard lock;
+            screen_empty = !departures_screen.hasDepartures();
+        }
+        if (failed_fetches >= SNAPSHOT_AFTER_FAILED_FETCHES && screen_empty) {
+            DeparturesSnapshot::LoadResult result;
+            if (const auto snapshot = load_usable_snapshot(result)) {
+                show_snapshot(*snapshot);
+            }
+        }
+    } else if (outcome.status) {
+        failed_fetches = 0;
+        save_snapshot_if_due();
+    }
+
+    const auto decision = scheduler.next(outcome, Time::localHour());
+    refresh_stats.interval_ms = static_cast<uint32_t>(decision.interval.count());
+    refresh_stats.interval_reason = decision.reason;
+    ESP_LOGD(TAG, "Next refresh in %d ms (%s)", static_cast<int>(decision.interval.count()),
+             RefreshScheduler::reasonName(decision.reason));
+    schedule_next_refresh(decision.interval);
+}
 
+// Sleeps until something happens that's worth fetching the departures for
+void DeparturesRefresherTask(void *pvParameter) {
     auto apiClient = BvgApiClient();
+    RefreshScheduler scheduler;
+    int failed_fetches = 0;
+    bool network_up = false;
+    bool time_synced = false;
 
+    RefresherEvent event;
     while (true) {
-        if (xQueueReceive(departuresRefreshQueue, &message, 0) == pdPASS) {
-            fetch_and_process_trips(apiClient);
+        if (!RefresherEvents::receive(&event)) {
+            continue;
+        }
+        ESP_LOGD(TAG, "Refresher event: %s", RefresherEvents::name(event));
+
+        switch (event) {
+        case RefresherEvent::TimerTick:
+            job_stats[Jobs::index(Job::DeparturesRefresh)].record(refresh_due, std::chrono::steady_clock::now());
+            break;
+        case RefresherEvent::ManualRefresh:
+            break;
+        case RefresherEvent::SettingsChanged:
+            // Failures and streaks so far were about what was configured before
+            scheduler.reset();
+            failed_fetches = 0;
+            break;
+        case RefresherEvent::NetworkUp:
+            if (network_up) {
+                continue;
+            }
+            network_up = true;
+            scheduler.reset();
+            // Right after boot the clock isn't set yet, the first fetch waits for SNTP or the first timer tick
+            if (!time_synced) {
+                continue;
+            }
+            break;
+        case RefresherEvent::NetworkDown:
+            if (network_up) {
+                ESP_LOGI(TAG, "Network down, pausing the departures refresh");
+                esp_timer_stop(departuresRefreshTimerHandle);
+            }
+            network_up = false;
+            continue;
+        case RefresherEvent::TimeSynced:
+            // Later synchronizations only correct the drift, that's not worth a fetch
+            if (time_synced) {
+                continue;
+            }
+            time_synced = true;
+            break;
         }
-        std::this_thread::sleep_for(10ms);
+
+        if (!network_up) {
+            ESP_LOGD(TAG, "Network down, not refreshing");
+            continue;
+        }
+        refresh_departures(apiClient, scheduler, failed_fetches);
     }
 
     vTaskDelete(NULL);
 }
 
 const esp_timer_create_args_t departuresRefresherTimerArgs = {
-    .callback =
-        [](void *arg) {
-            uint8_t message = 1;
-            xQueueSend(departuresRefreshQueue, &message, 0);
-        },
+    .callback = [](void *arg) { RefresherEvents::post(RefresherEvent::TimerTick); },
     .name = "departuresRefreshTimer",
 };
 
-esp_timer_handle_t departuresRefreshTimerHandle = nullptr;
+// Fetches right away instead of waiting for the next scheduled refresh
+static void on_settings_changed_refresh(const Settings &previous, const Settings &current, void *context) {
+    RefresherEvents::post(RefresherEvent::SettingsChanged);
+}
 
-const esp_timer_create_args_t lastUpdatedRefreshTimerArgs = {
-    .callback = [](void *arg) { departures_screen.refreshLastUpdatedDisplay(); },
-    .name = "lastUpdatedRefreshTimer",
-};
+// The departures of the previous station must not linger until the first fetch for the new one completes
+static void on_settings_changed_ui(const Settings &previous, const Settings &current, void *context) {
+    if (current.sameStationAs(previous)) {
+        return;
+    }
 
-esp_timer_handle_t lastUpdatedRefreshTimerHandle = nullptr;
+    // Whatever the refresher publishes from here on for the previous station is dropped, and so is anything it
+    // published before that the LVGL task didn't pick up yet
+    departures_screen.dropBoardsBefore(current.version);
+    const ui_lock_guard lock;
+    if (!current.current_station) {
+        departures_screen.showStationNotFoundError();
+        return;
+    }
+    const auto &station = *current.current_station;
+    departures_screen.clean();
+    departures_screen.showLoadingMessage(station.name[0] != '\0' ? station.name : station.id);
+}
 
 static void wifi_timeout_callback(void *arg) {
     ESP_LOGW(TAG, "WiFi connection timeout after 20 seconds, showing reset button");
+    if (showing_boot_snapshot) {
+        // Keep the departures screen around, it's switched back to once connected
+        splash_screen.switchTo(LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
+    }
     splash_screen.showConnectingToWiFiWithResetButton(reset_wifi_and_reboot);
 }
 
 extern "C" void app_main(void) {
     printHealthStats("app_main start");
     ESP_ERROR_CHECK(esp_event_loop_create_default());
+#ifdef CONFIG_CPU_SAMPLER
+    ESP_ERROR_CHECK(CpuSampler::start());
+#endif
 
     LVGL_LCD::init();
     UIManager::init();
@@ -320,6 +564,8 @@ extern "C" void app_main(void) {
     NVSEngine::init();
     init_network_wifi_and_wifimanager();
 
+    // Created before the refresher task, which arms it as soon as it fetched something
+    ESP_ERROR_CHECK(esp_timer_create(&departuresRefresherTimerArgs, &departuresRefreshTimerHandle));
     xTaskCreatePinnedToCore(DeparturesRefresherTask, "DeparturesRefresherTask", 1024 * 5, NULL, 1, NULL, 1);
 
     bool provisioned = false;
@@ -339,6 +585,17 @@ extern "C" void app_main(void) {
         ESP_LOGI(TAG, "Already provisioned, starting Wi-Fi STA");
         splash_screen.showConnectingToWiFi();
 
+        // The last departures can be shown right away, the RTC keeps the time across software resets. After a cold
+        // power-up the clock starts from zero, so the snapshot waits for the first fetch instead.
+        // The splash screen is kept around for the Wi-Fi reset button.
+        DeparturesSnapshot::LoadResult result;
+        if (const auto snapshot = load_usable_snapshot(result)) {
+            departures_screen.switchTo(LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
+            show_snapshot(*snapshot);
+            showing_boot_snapshot = true;
+        }
+        DeparturesSnapshot::boot_load_result = result;
+
         /* We don't need the manager as device is already provisioned, so let's release it's resources */
         wifi_prov_mgr_deinit();
 
@@ -361,31 +618,27 @@ extern "C" void app_main(void) {
     /* Wait for Wi-Fi connection */
     xEventGroupWaitBits(wifi_event_group, WIFI_CONNECTED_EVENT, true, true, portMAX_DELAY);
 
-    if (provisioned) {
-        splash_screen.showConnectedSwitchingToMain();
-    } else {
-        provisioning_screen.showWiFiConnectedMessage();
-    }
+    if (!showing_boot_snapshot) {
+        if (provisioned) {
+            splash_screen.showConnectedSwitchingToMain();
+        } else {
+            provisioning_screen.showWiFiConnectedMessage();
+        }
 
-    std::this_thread::sleep_for(2s);
+        std::this_thread::sleep_for(2s);
+    }
 
     setup_http_server();
 
-    // TODO We should avoid starting the timer before we have a valid time from NTP
-    Time::initSNTP();
+    // The first fetch happens as soon as the clock is synchronized, the timer is a fallback in case SNTP is slow
+    Time::initSNTP([]() { RefresherEvents::post(RefresherEvent::TimeSynced); });
 
     departures_screen.switchTo();
     departures_screen.refreshLastUpdatedDisplay();
 
-    ESP_ERROR_CHECK(esp_timer_create(&departuresRefresherTimerArgs, &departuresRefreshTimerHandle));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(
-        departuresRefreshTimerHandle,
-        std::chrono::duration_cast<std::chrono::microseconds>(DEPARTURES_REFRESH_PERIOD).count()));
-
-    ESP_ERROR_CHECK(esp_timer_create(&lastUpdatedRefreshTimerArgs, &lastUpdatedRefreshTimerHandle));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(
-        lastUpdatedRefreshTimerHandle,
-        std::chrono::duration_cast<std::chrono::microseconds>(LAST_UPDATED_REFRESH_PERIOD).count()));
+    settings_cache.subscribe(on_settings_changed_refresh, nullptr);
+    settings_cache.subscribe(on_settings_changed_ui, nullptr);
+    schedule_next_refresh(RefreshScheduler::BASE_INTERVAL);
 
     printHealthStats("end of app_main");
 };
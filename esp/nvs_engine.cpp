@@ -3,13 +3,17 @@
 #include <variant>
 
 #include "nvs_engine.hpp"
+#include "settings.hpp"
 
 static const char *TAG = "NVS";
 
+static const Settings DEFAULTS;
 static const std::map<std::string, std::variant<int, bool, std::nullptr_t>> DEFAULT_SETTINGS = {
-    {"minDepartureMinutes", 0},
-    {"maxDepartureCount", 12},
-    {"showCancelledDepartures", true},
+    {"minDepartureMinutes", DEFAULTS.min_departure_minutes},
+    {"maxDepartureCount", DEFAULTS.max_departure_count},
+    {"showCancelledDepartures", DEFAULTS.show_cancelled_departures},
+    {"nightStartHour", DEFAULTS.night_start_hour},
+    {"nightEndHour", DEFAULTS.night_end_hour},
     {"currentStation", nullptr}};
 
 // Application data is stored in a separate NVS partition (app_nvs) which can be erased
@@ -34,6 +38,14 @@ void NVSEngine::init() {
     // Initialize default settings if they don't exist
     NVSEngine nvs_settings("suntransit");
     nvs_settings.initializeDefaultSettingsIfMissing();
+
+    // From now on the settings are only read from NVS when they're changed
+    JsonDocument doc;
+    if (nvs_settings.readSettings(&doc) == ESP_OK) {
+        settings_cache.set(Settings::fromJson(doc.as<JsonVariantConst>()));
+    } else {
+        ESP_LOGE(TAG, "Failed to load settings, using the defaults");
+    }
 };
 
 esp_err_t NVSEngine::readString(const std::string &key, std::string *result) {
@@ -61,6 +73,26 @@ esp_err_t NVSEngine::setString(const std::string &key, const std::string &value)
     return err;
 };
 
+esp_err_t NVSEngine::readBlob(const std::string &key, std::vector<uint8_t> *result) {
+    size_t len;
+    auto err = nvs_get_blob(this->handle, key.c_str(), nullptr, &len);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    result->resize(len);
+    return nvs_get_blob(this->handle, key.c_str(), result->data(), &len);
+};
+
+esp_err_t NVSEngine::setBlob(const std::string &key, const void *data, size_t length) {
+    auto err = nvs_set_blob(this->handle, key.c_str(), data, length);
+    if (err) {
+        return err;
+    }
+    err = nvs_commit(this->handle);
+    return err;
+};
+
 esp_err_t NVSEngine::readSettings(JsonDocument *doc) {
     std::string settings;
     auto err = this->readString("settings", &settings);
@@ -75,6 +107,13 @@ esp_err_t NVSEngine::readSettings(JsonDocument *doc) {
         return ESP_FAIL;
     }
 
+    // Settings saved by older firmware versions lack the keys added since
+    for (const auto &[key, value] : DEFAULT_SETTINGS) {
+        if (!(*doc)[key].is<JsonVariant>()) {
+            std::visit([&](const auto &v) { (*doc)[key] = v; }, value);
+        }
+    }
+
     return ESP_OK;
 };
 
@@ -84,6 +123,18 @@ esp_err_t NVSEngine::setSettings(const JsonDocument &doc) {
     return this->setString("settings", settings);
 };
 
+ProductMask NVSEngine::parseEnabledProducts(JsonArrayConst products) {
+    ProductMask mask = 0;
+    for (const auto product : products) {
+        const char *name = product;
+        const auto parsed = name != nullptr ? Products::fromName(name) : std::nullopt;
+        if (parsed) {
+            mask |= Products::bit(*parsed);
+        }
+    }
+    return mask;
+};
+
 esp_err_t NVSEngine::initializeDefaultSettingsIfMissing() {
     std::string settings;
     auto err = this->readString("settings", &settings);
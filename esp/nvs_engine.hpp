@@ -2,6 +2,9 @@
 #include <esp_err.h>
 #include <nvs_flash.h>
 #include <string>
+#include <vector>
+
+#include "product.hpp"
 
 class NVSEngine {
   public:
@@ -10,9 +13,13 @@ class NVSEngine {
     static void init();
     esp_err_t readString(const std::string &key, std::string *result);
     esp_err_t setString(const std::string &key, const std::string &value);
+    esp_err_t readBlob(const std::string &key, std::vector<uint8_t> *result);
+    esp_err_t setBlob(const std::string &key, const void *data, size_t length);
     esp_err_t readSettings(JsonDocument *doc);
     esp_err_t setSettings(const JsonDocument &doc);
     esp_err_t initializeDefaultSettingsIfMissing();
+    // Settings store products by name (as the frontend sends them), unknown names are ignored
+    static ProductMask parseEnabledProducts(JsonArrayConst products);
 
   private:
     nvs_handle_t handle;
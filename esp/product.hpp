@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Transport products as named by the BVG API. `Unknown` stands for any product this firmware doesn't know yet, it
+// can't be requested or configured but its departures are still shown.
+enum class Product : uint8_t { Suburban, Subway, Tram, Bus, Ferry, Express, Regional, Unknown };
+
+// One bit per `Product`, see `Products::bit`
+using ProductMask = uint8_t;
+
+namespace Products {
+// Indexed by `Product`, `Unknown` excluded
+inline constexpr std::string_view NAMES[] = {"suburban", "subway", "tram", "bus", "ferry", "express", "regional"};
+inline constexpr size_t COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+constexpr size_t index(Product product) { return static_cast<size_t>(product); }
+
+// For tables indexed by `Product` that have an entry for `Unknown` too
+inline constexpr size_t COUNT_WITH_UNKNOWN = index(Product::Unknown) + 1;
+
+constexpr Product fromIndex(size_t index) { return static_cast<Product>(index); }
+
+constexpr std::string_view name(Product product) {
+    return product == Product::Unknown ? std::string_view("unknown") : NAMES[index(product)];
+}
+
+constexpr ProductMask bit(Product product) { return static_cast<ProductMask>(1U << index(product)); }
+
+constexpr bool contains(ProductMask mask, Product product) { return (mask & bit(product)) != 0; }
+
+constexpr std::optional<Product> fromName(std::string_view name) {
+    for (size_t i = 0; i < COUNT; i++) {
+        if (NAMES[i] == name) {
+            return fromIndex(i);
+        }
+    }
+    return std::nullopt;
+}
+
+static_assert(COUNT == index(Product::Regional) + 1, "NAMES must have one entry per Product");
+static_assert(COUNT <= sizeof(ProductMask) * 8, "ProductMask is too small");
+static_assert(fromName("tram") == Product::Tram);
+} // namespace Products
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <array>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "latency_probes.hpp"
+#include "prometheus_metrics.hpp"
+#include "refresh_stats.hpp"
+
+static const char *TAG = "PrometheusMetrics";
+
+// Collects the response in a small buffer and sends it as a chunk whenever that fills up
+class ChunkWriter {
+  public:
+    explicit ChunkWriter(httpd_req_t *req) : req(req) {}
+
+    // A single call must not produce more than `sizeof(buffer)` characters, longer output is truncated
+    __attribute__((format(printf, 2, 3))) void printf(const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        const auto written = append(format, args);
+        va_end(args);
+        if (written < 0 || static_cast<size_t>(written) < sizeof(buffer) - length) {
+            length += written < 0 ? 0 : written;
+            return;
+        }
+
+        // Didn't fit, send what's there and try again with the whole buffer
+        flush();
+        va_start(args, format);
+        const auto rewritten = append(format, args);
+        va_end(args);
+        if (rewritten > 0) {
+            length = std::min(static_cast<size_t>(rewritten), sizeof(buffer) - 1);
+        }
+    }
+
+    // Sends the rest and ends the response
+    esp_err_t finish() {
+        flush();
+        if (error == ESP_OK) {
+            error = httpd_resp_send_chunk(req, nullptr, 0);
+        }
+        return error;
+    }
+
+  private:
+    httpd_req_t *req;
+    char buffer[512];
+    size_t length = 0;
+    esp_err_t error = ESP_OK;
+
+    int append(const char *format, va_list args) {
+        return std::vsnprintf(buffer + length, sizeof(buffer) - length, format, args);
+    }
+
+    void flush() {
+        // Once the client is gone there's no point in formatting the rest
+        if (length > 0 && error == ESP_OK) {
+            error = httpd_resp_send_chunk(req, buffer, static_cast<ssize_t>(length));
+        }
+        length = 0;
+    }
+};
+
+static void family(ChunkWriter &writer, const char *name, const char *type, const char *help) {
+    writer.printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void single(ChunkWriter &writer, const char *name, const char *type, const char *help, uint64_t value) {
+    family(writer, name, type, help);
+    writer.printf("%s %llu\n", name, static_cast<unsigned long long>(value));
+}
+
+static void send_memory(ChunkWriter &writer) {
+    single(writer, "suntransit_heap_free_bytes", "gauge", "Free heap", esp_get_free_heap_size());
+    single(writer, "suntransit_heap_minimum_free_bytes", "gauge", "Lowest free heap since boot",
+           esp_get_minimum_free_heap_size());
+    single(writer, "suntransit_heap_largest_free_block_bytes", "gauge", "Largest block that can be allocated",
+           heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT));
+    single(writer, "suntransit_uptime_seconds", "counter", "Time since boot", esp_timer_get_time() / 1000000);
+}
+
+static void send_refresh(ChunkWriter &writer) {
+    single(writer, "suntransit_refresh_cycles_total", "counter", "Departures refresh cycles",
+           refresh_stats.cycles.load());
+    single(writer, "suntransit_refresh_failed_cycles_total", "counter", "Refresh cycles whose fetch failed",
+           refresh_stats.failed_cycles.load());
+    single(writer, "suntransit_refresh_skipped_cycles_total", "counter",
+           "Refresh cycles cut short because the departures didn't change", refresh_stats.skipped_cycles.load());
+    single(writer, "suntransit_http_not_modified_responses_total", "counter", "304 responses to departures fetches",
+           refresh_stats.not_modified_responses.load());
+    single(writer, "suntransit_http_received_bytes_total", "counter", "Response bodies received by departures fetches",
+           refresh_stats.bytes_received.load());
+}
+
+#ifdef CONFIG_REFRESH_LATENCY_PROBES
+static void send_latency(ChunkWriter &writer) {
+    static constexpr const char *NAME = "suntransit_refresh_stage_duration_seconds";
+    family(writer, NAME, "histogram", "Duration of the stages of a departures refresh");
+    for (size_t i = 0; i < RefreshStages::COUNT; i++) {
+        const auto &histogram = refresh_latency[i];
+        const auto *stage = RefreshStages::NAMES[i];
+        // The histogram counts per bucket, Prometheus wants cumulative counts
+        uint32_t cumulative = 0;
+        for (size_t bucket = 0; bucket < LatencyHistogram::BOUNDS_US.size(); bucket++) {
+            cumulative += histogram.buckets[bucket].load();
+            writer.printf("%s_bucket{stage=\"%s\",le=\"%g\"} %lu\n", NAME, stage,
+                          LatencyHistogram::BOUNDS_US[bucket] / 1e6, static_cast<unsigned long>(cumulative));
+        }
+        // Read separately from the buckets, so it might be off by a sample recorded in between
+        const auto samples = histogram.samples.load();
+        writer.printf("%s_bucket{stage=\"%s\",le=\"+Inf\"} %lu\n", NAME, stage, static_cast<unsigned long>(samples));
+        writer.printf("%s_sum{stage=\"%s\"} %.6f\n", NAME, stage, histogram.sum_us.load() / 1e6);
+        writer.printf("%s_count{stage=\"%s\"} %lu\n", NAME, stage, static_cast<unsigned long>(samples));
+    }
+    single(writer, "suntransit_refresh_stage_dropped_samples_total", "counter",
+           "Stage durations not recorded because the task moved to the other core", dropped_latency_samples.load());
+}
+#endif
+
+#ifdef CONFIG_FREERTOS_USE_TRACE_FACILITY
+#if defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS) && defined(CONFIG_FREERTOS_RUN_TIME_STATS_USING_ESP_TIMER)
+// FreeRTOS counts the runtime in µs in 32 bits, which wraps after 71 minutes. Summing up the difference since the
+// previous scrape gives a counter that doesn't, as long as scrapes are less than 71 minutes apart.
+struct TaskRuntime {
+    TaskHandle_t handle;
+    decltype(TaskStatus_t::ulRunTimeCounter) last_counter;
+    uint64_t total_us;
+};
+
+static constexpr size_t MAX_TRACKED_TASKS = 32;
+// Only touched by the HTTP server task
+static std::array<TaskRuntime, MAX_TRACKED_TASKS> task_runtimes;
+static size_t task_runtime_count = 0;
+
+static uint64_t total_runtime_us(const TaskStatus_t &task) {
+    for (size_t i = 0; i < task_runtime_count; i++) {
+        auto &runtime = task_runtimes[i];
+        if (runtime.handle == task.xHandle) {
+            runtime.total_us += task.ulRunTimeCounter - runtime.last_counter;
+            runtime.last_counter = task.ulRunTimeCounter;
+            return runtime.total_us;
+        }
+    }
+    if (task_runtime_count < task_runtimes.size()) {
+        task_runtimes[task_runtime_count++] = {
+            .handle = task.xHandle, .last_counter = task.ulRunTimeCounter, .total_us = task.ulRunTimeCounter};
+    }
+    return task.ulRunTimeCounter;
+}
+#endif
+
+static void send_tasks(ChunkWriter &writer) {
+    const auto task_count = uxTaskGetNumberOfTasks();
+    auto *tasks = static_cast<TaskStatus_t *>(malloc(sizeof(TaskStatus_t) * task_count));
+    if (tasks == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate memory for the task states");
+        return;
+    }
+    const auto reported = uxTaskGetSystemState(tasks, task_count, nullptr);
+
+    family(writer, "suntransit_task_stack_high_water_mark_bytes", "gauge", "Least free stack space of a task so far");
+    for (UBaseType_t i = 0; i < reported; i++) {
+        writer.printf("suntransit_task_stack_high_water_mark_bytes{task=\"%s\"} %lu\n", tasks[i].pcTaskName,
+                      static_cast<unsigned long>(tasks[i].usStackHighWaterMark));
+    }
+
+#if defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS) && defined(CONFIG_FREERTOS_RUN_TIME_STATS_USING_ESP_TIMER)
+    family(writer, "suntransit_task_runtime_seconds_total", "counter", "CPU time used by a task");
+    for (UBaseType_t i = 0; i < reported; i++) {
+        writer.printf("suntransit_task_runtime_seconds_total{task=\"%s\"} %.6f\n", tasks[i].pcTaskName,
+                      total_runtime_us(tasks[i]) / 1e6);
+    }
+#endif
+
+    free(tasks);
+}
+#endif
+
+namespace PrometheusMetrics {
+esp_err_t send(httpd_req_t *req) {
+    httpd_resp_set_type(req, "text/plain; version=0.0.4; charset=utf-8");
+
+    ChunkWriter writer(req);
+    send_memory(writer);
+    send_refresh(writer);
+#ifdef CONFIG_REFRESH_LATENCY_PROBES
+    send_latency(writer);
+#endif
+#ifdef CONFIG_FREERTOS_USE_TRACE_FACILITY
+    send_tasks(writer);
+#endif
+
+    const auto err = writer.finish();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Sending the metrics failed: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+} // namespace PrometheusMetrics
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <esp_err.h>
+#include <esp_http_server.h>
+
+namespace PrometheusMetrics {
+// Responds with the device's metrics in the Prometheus text exposition format. The response is streamed in small
+// chunks, so scraping needs neither a large buffer nor a JSON document.
+esp_err_t send(httpd_req_t *req);
+} // namespace PrometheusMetrics
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <esp_log.h>
+#include <esp_random.h>
+
+#include "refresh_scheduler.hpp"
+
+static const char *TAG = "RefreshScheduler";
+
+RefreshScheduler::Decision RefreshScheduler::next(const RefreshOutcome &outcome, std::optional<int> local_hour) {
+    using std::chrono::milliseconds;
+
+    if (!outcome.status) {
+        consecutive_failures = 0;
+        unchanged_streak = 0;
+        return {.interval = BASE_INTERVAL, .reason = RefreshReason::Idle};
+    }
+
+    if (*outcome.status == FetchStatus::Failed) {
+        consecutive_failures++;
+        unchanged_streak = 0;
+
+        // 10 s, 20 s, 40 s, ... capped at `MAX_BACKOFF_INTERVAL`
+        const auto exponent = std::min<uint32_t>(consecutive_failures - 1, 5);
+        const auto backoff = std::min(BASE_INTERVAL * (1 << exponent), MAX_BACKOFF_INTERVAL);
+        const auto jitter_percent = static_cast<int>(esp_random() % (2 * JITTER_PERCENT + 1)) - JITTER_PERCENT;
+        const auto interval = backoff + backoff * jitter_percent / 100;
+        ESP_LOGD(TAG, "%d consecutive failures, backing off for %d ms", static_cast<int>(consecutive_failures),
+                 static_cast<int>(interval.count()));
+        return {.interval = interval, .reason = RefreshReason::Backoff};
+    }
+
+    consecutive_failures = 0;
+    unchanged_streak = *outcome.status == FetchStatus::Unchanged ? unchanged_streak + 1 : 0;
+
+    Decision decision{.interval = BASE_INTERVAL, .reason = RefreshReason::Changed};
+    const auto consider = [&decision](milliseconds interval, RefreshReason reason) {
+        if (interval > decision.interval) {
+            decision = {.interval = interval, .reason = reason};
+        }
+    };
+
+    consider(std::min(BASE_INTERVAL + UNCHANGED_STEP * unchanged_streak, MAX_UNCHANGED_INTERVAL),
+             RefreshReason::Unchanged);
+    if (outcome.next_departure) {
+        consider(std::chrono::duration_cast<milliseconds>(*outcome.next_departure) / HORIZON_DIVISOR,
+                 RefreshReason::DepartureHorizon);
+    }
+    if (local_hour && outcome.night_schedule.contains(*local_hour)) {
+        consider(NIGHT_INTERVAL, RefreshReason::Night);
+    }
+
+    decision.interval = std::min(decision.interval, MAX_INTERVAL);
+    return decision;
+}
+
+void RefreshScheduler::reset() {
+    consecutive_failures = 0;
+    unchanged_streak = 0;
+}
+
+const char *RefreshScheduler::reasonName(RefreshReason reason) {
+    switch (reason) {
+    case RefreshReason::Changed:
+        return "changed";
+    case RefreshReason::Unchanged:
+        return "unchanged";
+    case RefreshReason::DepartureHorizon:
+        return "departure_horizon";
+    case RefreshReason::Night:
+        return "night";
+    case RefreshReason::Backoff:
+        return "backoff";
+    case RefreshReason::Idle:
+        return "idle";
+    }
+    return "unknown";
+}
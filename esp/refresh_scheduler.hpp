@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "bvg_api_client.hpp"
+
+enum class RefreshReason : uint8_t {
+    // The departures changed, keep refreshing at the base rate
+    Changed,
+    // The same departures came back several times in a row
+    Unchanged,
+    // The next departure is far enough away that nothing visible will change soon
+    DepartureHorizon,
+    // Inside the configured night-time window
+    Night,
+    // Fetching failed, exponential backoff with jitter
+    Backoff,
+    // Nothing to fetch, e.g. because no station is configured yet
+    Idle,
+};
+
+// Night-time window in local hours, e.g. 1 to 5 means from 01:00 until 04:59.
+// A window where start and end are equal is disabled.
+struct NightSchedule {
+    int start_hour;
+    int end_hour;
+
+    bool contains(int hour) const {
+        if (start_hour == end_hour) {
+            return false;
+        }
+        if (start_hour < end_hour) {
+            return hour >= start_hour && hour < end_hour;
+        }
+        // Wraps around midnight, e.g. 23 to 5
+        return hour >= start_hour || hour < end_hour;
+    }
+};
+
+struct RefreshOutcome {
+    // Empty if nothing was fetched
+    std::optional<FetchStatus> status;
+    // Time until the earliest departure shown on screen, if any
+    std::optional<std::chrono::seconds> next_departure;
+    NightSchedule night_schedule;
+};
+
+// Picks the time until the next departures fetch, replacing the old fixed 10 s period.
+// The countdowns on screen are projected locally between fetches, so fetching only needs to pick up delays and
+// changes. Outside of failures the interval never exceeds `MAX_INTERVAL`.
+class RefreshScheduler {
+  public:
+    struct Decision {
+        std::chrono::milliseconds interval;
+        RefreshReason reason;
+    };
+
+    static constexpr std::chrono::milliseconds BASE_INTERVAL = std::chrono::seconds(10);
+    static constexpr std::chrono::milliseconds MAX_INTERVAL = std::chrono::minutes(5);
+
+    // `local_hour` is empty while the clock isn't synchronized yet, which disables the night-time schedule
+    Decision next(const RefreshOutcome &outcome, std::optional<int> local_hour);
+    // Forgets failures and unchanged streaks, e.g. once another station was configured
+    void reset();
+    static const char *reasonName(RefreshReason reason);
+
+  private:
+    static constexpr std::chrono::milliseconds UNCHANGED_STEP = std::chrono::seconds(10);
+    static constexpr std::chrono::milliseconds MAX_UNCHANGED_INTERVAL = std::chrono::seconds(60);
+    static constexpr std::chrono::milliseconds NIGHT_INTERVAL = MAX_INTERVAL;
+    static constexpr std::chrono::milliseconds MAX_BACKOFF_INTERVAL = std::chrono::minutes(5);
+    // Refresh at least this many times before the next departure is due
+    static constexpr int HORIZON_DIVISOR = 10;
+    // Backoff intervals are spread by up to ±20% so that devices don't retry in lockstep
+    static constexpr int JITTER_PERCENT = 20;
+
+    uint32_t consecutive_failures = 0;
+    uint32_t unchanged_streak = 0;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "refresh_scheduler.hpp"
+
+// Counters about the departures refresh cycles, exposed via `/api/sysinfo`
+struct RefreshStats {
+    std::atomic<uint32_t> cycles{0};
+    std::atomic<uint32_t> failed_cycles{0};
+    // Cycles cut short because the departures didn't change since the last one
+    std::atomic<uint32_t> skipped_cycles{0};
+    std::atomic<uint32_t> not_modified_responses{0};
+    // Response bodies of departures fetches, including error responses
+    std::atomic<uint64_t> bytes_received{0};
+    // Last decision of the `RefreshScheduler`
+    std::atomic<uint32_t> interval_ms{0};
+    std::atomic<RefreshReason> interval_reason{RefreshReason::Idle};
+};
+
+inline RefreshStats refresh_stats;
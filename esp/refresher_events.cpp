@@ -0,0 +1,40 @@
+#include <esp_log.h>
+#include <freertos/queue.h>
+
+#include "refresher_events.hpp"
+
+static const char *TAG = "RefresherEvents";
+
+// Deep enough for a burst like network up, time synced and settings changed while a fetch is running
+static const constexpr UBaseType_t QUEUE_LENGTH = 8;
+static QueueHandle_t queue = xQueueCreate(QUEUE_LENGTH, sizeof(RefresherEvent));
+
+namespace RefresherEvents {
+bool post(RefresherEvent event) {
+    if (xQueueSend(queue, &event, 0) != pdPASS) {
+        ESP_LOGW(TAG, "Queue full, dropping %s event", name(event));
+        return false;
+    }
+    return true;
+}
+
+bool receive(RefresherEvent *event, TickType_t timeout) { return xQueueReceive(queue, event, timeout) == pdPASS; }
+
+const char *name(RefresherEvent event) {
+    switch (event) {
+    case RefresherEvent::TimerTick:
+        return "timer_tick";
+    case RefresherEvent::SettingsChanged:
+        return "settings_changed";
+    case RefresherEvent::NetworkUp:
+        return "network_up";
+    case RefresherEvent::NetworkDown:
+        return "network_down";
+    case RefresherEvent::TimeSynced:
+        return "time_synced";
+    case RefresherEvent::ManualRefresh:
+        return "manual_refresh";
+    }
+    return "unknown";
+}
+} // namespace RefresherEvents
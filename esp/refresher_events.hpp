@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <freertos/FreeRTOS.h>
+
+// What wakes up the task refreshing the departures, which otherwise blocks
+enum class RefresherEvent : uint8_t {
+    // The interval picked by the `RefreshScheduler` elapsed
+    TimerTick,
+    SettingsChanged,
+    NetworkUp,
+    NetworkDown,
+    // The clock was synchronized via SNTP, also sent on every later resync
+    TimeSynced,
+    // Requested via `POST /api/refresh`
+    ManualRefresh,
+};
+
+namespace RefresherEvents {
+// Never blocks, so it can be used from timer callbacks and event handlers. Fails only if the queue is full.
+bool post(RefresherEvent event);
+// Blocks until an event arrives or `timeout` passes
+bool receive(RefresherEvent *event, TickType_t timeout = portMAX_DELAY);
+const char *name(RefresherEvent event);
+} // namespace RefresherEvents
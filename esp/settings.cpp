@@ -0,0 +1,79 @@
+#include <cstring>
+#include <esp_log.h>
+
+#include "nvs_engine.hpp"
+#include "settings.hpp"
+
+static const char *TAG = "settings";
+
+Settings Settings::fromJson(JsonVariantConst doc) {
+    const Settings defaults;
+    Settings settings;
+    settings.min_departure_minutes = doc["minDepartureMinutes"] | defaults.min_departure_minutes;
+    settings.max_departure_count = doc["maxDepartureCount"] | defaults.max_departure_count;
+    settings.show_cancelled_departures = doc["showCancelledDepartures"] | defaults.show_cancelled_departures;
+    settings.night_start_hour = doc["nightStartHour"] | defaults.night_start_hour;
+    settings.night_end_hour = doc["nightEndHour"] | defaults.night_end_hour;
+
+    const auto station = doc["currentStation"];
+    const char *id = station["id"];
+    if (id != nullptr && std::strlen(id) < sizeof(StationSettings::id)) {
+        StationSettings current_station{};
+        std::strcpy(current_station.id, id);
+        const char *name = station["name"] | "";
+        std::strncpy(current_station.name, name, sizeof(current_station.name) - 1);
+        current_station.enabled_products =
+            NVSEngine::parseEnabledProducts(station["enabledProducts"].as<JsonArrayConst>());
+        settings.current_station = current_station;
+    } else if (id != nullptr) {
+        ESP_LOGE(TAG, "Ignoring station with overlong id %s", id);
+    }
+
+    return settings;
+}
+
+bool Settings::sameStationAs(const Settings &other) const {
+    if (!current_station || !other.current_station) {
+        return current_station.has_value() == other.current_station.has_value();
+    }
+    return std::strcmp(current_station->id, other.current_station->id) == 0;
+}
+
+Settings SettingsCache::get() const {
+    const std::lock_guard lock(mutex);
+    return settings;
+}
+
+void SettingsCache::set(const Settings &new_settings) {
+    Settings previous;
+    Settings current;
+    std::array<Subscription, MAX_LISTENERS> to_notify;
+    size_t to_notify_count;
+    {
+        const std::lock_guard lock(mutex);
+        previous = settings;
+        settings = new_settings;
+        settings.version = previous.version + 1;
+        current = settings;
+        current_version = current.version;
+        to_notify = subscriptions;
+        to_notify_count = subscription_count;
+    }
+
+    ESP_LOGD(TAG, "Settings changed (version %d), notifying %d listeners", static_cast<int>(current.version),
+             static_cast<int>(to_notify_count));
+    // Outside of the lock, so that listeners are free to read the settings again
+    for (size_t i = 0; i < to_notify_count; i++) {
+        to_notify[i].listener(previous, current, to_notify[i].context);
+    }
+}
+
+bool SettingsCache::subscribe(Listener listener, void *context) {
+    const std::lock_guard lock(mutex);
+    if (subscription_count == MAX_LISTENERS) {
+        ESP_LOGE(TAG, "Too many settings listeners");
+        return false;
+    }
+    subscriptions[subscription_count++] = {.listener = listener, .context = context};
+    return true;
+}
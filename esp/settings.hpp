@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+#include "product.hpp"
+
+struct StationSettings {
+    // Longer ids are rejected when saving the settings, the BVG ones have 9 digits
+    char id[32];
+    // Only used for messages on screen, truncated if needed
+    char name[64];
+    ProductMask enabled_products;
+};
+
+// Typed version of the settings stored as JSON in NVS, see `NVSEngine::readSettings`
+struct Settings {
+    int min_departure_minutes = 0;
+    int max_departure_count = 12;
+    bool show_cancelled_departures = true;
+    int night_start_hour = 1;
+    int night_end_hour = 5;
+    std::optional<StationSettings> current_station;
+
+    // Bumped by `SettingsCache` on every change, so that users can tell whether what they derived is still current
+    uint32_t version = 0;
+
+    // Values that don't fit the types above fall back to the defaults
+    static Settings fromJson(JsonVariantConst doc);
+    bool sameStationAs(const Settings &other) const;
+};
+
+// The settings kept in RAM, so that the refresh cycle doesn't have to read and parse them from NVS every time.
+// Loaded once by `NVSEngine::init` and replaced by the settings HTTP handler after saving them.
+// Safe to use from any task.
+class SettingsCache {
+  public:
+    // Called from the task that changed the settings, after the new ones are in place
+    using Listener = void (*)(const Settings &previous, const Settings &current, void *context);
+    static const constexpr size_t MAX_LISTENERS = 4;
+
+    Settings get() const;
+    uint32_t version() const { return current_version.load(); }
+    // Replaces the settings and notifies the listeners
+    void set(const Settings &settings);
+    bool subscribe(Listener listener, void *context);
+
+  private:
+    struct Subscription {
+        Listener listener;
+        void *context;
+    };
+
+    mutable std::mutex mutex;
+    Settings settings;
+    std::atomic<uint32_t> current_version{0};
+    std::array<Subscription, MAX_LISTENERS> subscriptions{};
+    size_t subscription_count = 0;
+};
+
+inline SettingsCache settings_cache;
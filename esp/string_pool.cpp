@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <cstring>
+#include <esp_log.h>
+
+#include "hash.hpp"
+#include "string_pool.hpp"
+
+static const char *TAG = "StringPool";
+
+void StringPool::nextGeneration() { generation++; }
+
+std::optional<InternedString> StringPool::intern(std::string_view text) {
+    // Hashing the full text keeps truncated strings with a common prefix apart
+    const auto hash = Hash::fnv1a(text);
+    const auto length = std::min(text.size(), MAX_LENGTH);
+
+    Entry *free_entry = nullptr;
+    Entry *oldest_entry = nullptr;
+    for (auto &entry : entries) {
+        if (!entry.used) {
+            if (free_entry == nullptr) {
+                free_entry = &entry;
+            }
+            continue;
+        }
+
+        if (entry.hash == hash && entry.length == length && std::memcmp(entry.text, text.data(), length) == 0) {
+            entry.generation = generation;
+            hit_count++;
+            return InternedString{static_cast<uint8_t>(&entry - entries)};
+        }
+
+        const bool evictable = entry.generation != generation;
+        if (evictable && (oldest_entry == nullptr || entry.generation < oldest_entry->generation)) {
+            oldest_entry = &entry;
+        }
+    }
+
+    miss_count++;
+
+    Entry *entry = free_entry;
+    if (entry == nullptr) {
+        if (oldest_entry == nullptr) {
+            ESP_LOGW(TAG, "All %d entries are in use, can't intern \"%.*s\"", static_cast<int>(CAPACITY),
+                     static_cast<int>(length), text.data());
+            failure_count++;
+            return std::nullopt;
+        }
+        ESP_LOGD(TAG, "Evicting \"%s\"", oldest_entry->text);
+        entry = oldest_entry;
+        eviction_count++;
+    } else {
+        used_entries++;
+    }
+
+    if (length < text.size()) {
+        ESP_LOGD(TAG, "Truncating \"%.*s\" to %d characters", static_cast<int>(text.size()), text.data(),
+                 static_cast<int>(MAX_LENGTH));
+    }
+
+    entry->hash = hash;
+    entry->generation = generation;
+    entry->length = static_cast<uint8_t>(length);
+    entry->used = true;
+    std::memcpy(entry->text, text.data(), length);
+    entry->text[length] = '\0';
+    return InternedString{static_cast<uint8_t>(entry - entries)};
+}
+
+void StringPool::touch(InternedString handle) { entries[handle.index].generation = generation; }
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Handle to a string stored in a `StringPool`, to be resolved with `StringPool::get`
+struct InternedString {
+    uint8_t index;
+
+    bool operator==(const InternedString &other) const = default;
+};
+
+// Bounded interning table for the line and direction names of the departures.
+// A station only ever shows a few dozen distinct names, so instead of allocating them again as `std::string` for
+// every trip of every refresh cycle, they are copied once into fixed slots that live for the whole uptime. This keeps
+// the refresh cycle from churning (and over weeks fragmenting) the heap.
+//
+// Strings used during the current cycle are never evicted, so handles stay valid at least until the next call to
+// `nextGeneration`. Once the table is full, the least recently used string of an older cycle makes room.
+//
+// Only meant to be used from the task refreshing the departures, except for the statistics.
+class StringPool {
+  public:
+    // Enough for `line + direction` of the maximum number of departures several times over
+    static const constexpr size_t CAPACITY = 96;
+    // Longer strings are truncated, the UI cuts long directions off way before that anyway
+    static const constexpr size_t MAX_LENGTH = 63;
+
+    // Starts a new refresh cycle, strings not used since the last one become candidates for eviction
+    void nextGeneration();
+    // Returns the handle of `text`, copying it into the table if it isn't there yet.
+    // Fails only if every slot is in use by the current cycle.
+    std::optional<InternedString> intern(std::string_view text);
+    // Marks a string as used by the current cycle, for handles carried over from an earlier one
+    void touch(InternedString handle);
+    const char *get(InternedString handle) const { return entries[handle.index].text; }
+
+    size_t size() const { return used_entries.load(); }
+    uint32_t hits() const { return hit_count.load(); }
+    uint32_t misses() const { return miss_count.load(); }
+    uint32_t evictions() const { return eviction_count.load(); }
+    uint32_t failures() const { return failure_count.load(); }
+
+  private:
+    struct Entry {
+        uint64_t hash = 0;
+        uint32_t generation = 0;
+        uint8_t length = 0;
+        bool used = false;
+        char text[MAX_LENGTH + 1] = "";
+    };
+
+    Entry entries[CAPACITY];
+    uint32_t generation = 1;
+
+    std::atomic<size_t> used_entries{0};
+    std::atomic<uint32_t> hit_count{0};
+    std::atomic<uint32_t> miss_count{0};
+    std::atomic<uint32_t> eviction_count{0};
+    std::atomic<uint32_t> failure_count{0};
+};
+
+static_assert(StringPool::CAPACITY <= UINT8_MAX + 1, "Handles store the index in a uint8_t");
+
+inline StringPool string_pool;
@@ -3,18 +3,24 @@
 #include <sys/time.h>
 #include <time.h>
 
+#include "iso8601.hpp"
 #include "time.hpp"
 
 static const char *TAG = "Time";
 static auto synced = false;
+static void (*on_synced_callback)() = nullptr;
 
 namespace Time {
 void callbackOnNtpUpdate(timeval *tv) {
     ESP_LOGI(TAG, "NTP updated, current time is: %s", timeNowAscii().c_str());
     synced = true;
+    if (on_synced_callback != nullptr) {
+        on_synced_callback();
+    }
 };
 
-esp_err_t initSNTP() {
+esp_err_t initSNTP(void (*on_synced)()) {
+    on_synced_callback = on_synced;
     if (!synced) {
         setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
         tzset();
@@ -45,6 +51,17 @@ int64_t epochMillis() {
     return count;
 }
 
+std::optional<int> localHour() {
+    if (!synced) {
+        return std::nullopt;
+    }
+
+    const std::time_t timeNow{std::chrono::system_clock::to_time_t(timePointNow())};
+    std::tm local;
+    localtime_r(&timeNow, &local);
+    return local.tm_hour;
+}
+
 std::string timeNowAscii() {
     const std::time_t timeNow{std::chrono::system_clock::to_time_t(timePointNow())};
 
@@ -52,42 +69,15 @@ std::string timeNowAscii() {
 }
 
 const std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds>
-iSO8601StringToTimePoint(const std::string &iso8601) {
-    std::tm t = {};
-    // F: Equivalent to %Y-%m-%d, the ISO 8601 date format.
-    // T: ISO 8601 time format (HH:MM:SS), equivalent to %H:%M:%S
-    auto result = strptime(iso8601.c_str(), "%FT%T", &t);
-    if (result == nullptr) {
-        ESP_LOGE(TAG, "Failed to parse ISO8601 string: %s", iso8601.c_str());
+iSO8601StringToTimePoint(std::string_view iso8601) {
+    // The BVG API returns Berlin local times with their UTC offset (e.g. `+02:00` during CEST),
+    // the offset is applied by the parser so we don't depend on the TZ configured on the device.
+    const auto result = ISO8601::parse(iso8601);
+    if (!result) {
+        ESP_LOGE(TAG, "Failed to parse ISO8601 string: %.*s", static_cast<int>(iso8601.size()), iso8601.data());
         return std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds>();
     }
 
-    // The BVG API returns times in Berlin local time (CET/CEST).
-    // We need to interpret the parsed time as already being in the correct local timezone,
-    // without applying any additional timezone conversion.
-    // Since mktime() applies local timezone conversion, we need to compensate for it.
-
-    // Get the current timezone offset to compensate for mktime's conversion
-    auto now = time(nullptr);
-    auto local_tm = *localtime(&now);
-    auto utc_tm = *gmtime(&now);
-
-    // Calculate timezone offset in seconds (local - UTC)
-    auto local_time = mktime(&local_tm);
-    auto utc_time = mktime(&utc_tm);
-    auto tz_offset = local_time - utc_time;
-
-    // Use mktime to get the timestamp, then subtract the timezone offset
-    // to get the actual time as intended by the BVG API
-    auto time = mktime(&t);
-    if (time == -1) {
-        ESP_LOGE(TAG, "Failed to convert std::tm to std::time_t");
-        return std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds>();
-    }
-
-    // Subtract the timezone offset to get the correct time
-    time -= tz_offset;
-
-    return std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds>(std::chrono::seconds(time));
+    return *result;
 }
 } // namespace Time
@@ -2,13 +2,18 @@
 
 #include <chrono>
 #include <esp_err.h>
+#include <optional>
 #include <string>
+#include <string_view>
 
 namespace Time {
-esp_err_t initSNTP();
+// `on_synced` is called from the SNTP task after every synchronization
+esp_err_t initSNTP(void (*on_synced)() = nullptr);
 const std::chrono::system_clock::time_point timePointNow();
 int64_t epochMillis();
 std::string timeNowAscii();
+// Hour of the day in Berlin, empty until the clock has been synchronized
+std::optional<int> localHour();
 const std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds>
-iSO8601StringToTimePoint(const std::string &iso8601);
+iSO8601StringToTimePoint(std::string_view iso8601);
 }; // namespace Time
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "product.hpp"
+#include "string_pool.hpp"
+
+struct Trip {
+    // `Hash::fnv1a` of the trip id. The ids run 40-70 characters and are only ever compared, so a trip can be copied
+    // without allocating.
+    const uint64_t tripHash;
+    const std::optional<std::chrono::system_clock::time_point> departureTime;
+    const std::chrono::system_clock::time_point plannedTime;
+    // Both live in `string_pool`
+    const InternedString directionName;
+    const InternedString lineName;
+    const Product productType;
+};
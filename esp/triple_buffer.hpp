@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free hand-over of the latest value from one producer to one consumer.
+// The producer fills `back()` and `publish()`es it, the consumer picks up the latest published value with
+// `consume()`. Values nobody consumed are simply overwritten. A third buffer in between means neither side ever
+// waits for the other or sees a half-written value.
+template <typename T> class TripleBuffer {
+  public:
+    // Producer side
+    T &back() { return buffers[back_index]; }
+    void publish() { back_index = ready.exchange(back_index | FRESH) & INDEX_MASK; }
+
+    // Consumer side, returns `nullptr` if nothing was published since the last call.
+    // The returned value stays valid and unchanged until the next call.
+    const T *consume() {
+        if ((ready.load() & FRESH) == 0) {
+            return nullptr;
+        }
+        front_index = ready.exchange(front_index) & INDEX_MASK;
+        return &buffers[front_index];
+    }
+
+  private:
+    static const constexpr uint8_t FRESH = 0x80;
+    static const constexpr uint8_t INDEX_MASK = 0x03;
+
+    T buffers[3];
+    uint8_t back_index = 0;
+    uint8_t front_index = 1;
+    // Index of the buffer in between, flagged with `FRESH` when it holds a value the consumer hasn't seen yet
+    std::atomic<uint8_t> ready{2};
+};
@@ -0,0 +1,58 @@
+#include "app_scheduler.hpp"
+#include "ui.hpp"
+
+void JobStats::record(std::chrono::steady_clock::time_point due, std::chrono::steady_clock::time_point started) {
+    // Timers never fire early, but a job may be due before the previous run of the same job was done
+    const auto lateness = started > due ? started - due : std::chrono::steady_clock::duration::zero();
+    const auto lateness_us =
+        static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(lateness).count());
+
+    if (runs.fetch_add(1) > 0) {
+        const auto previous = last_lateness_us.load();
+        const auto difference = lateness_us > previous ? lateness_us - previous : previous - lateness_us;
+        const auto jitter = jitter_us.load();
+        jitter_us = static_cast<uint32_t>(jitter + (static_cast<int64_t>(difference) - jitter) / 16);
+    }
+    last_lateness_us = lateness_us;
+    if (lateness_us > max_lateness_us) {
+        max_lateness_us = lateness_us;
+    }
+}
+
+namespace AppScheduler {
+
+struct UiJob {
+    Job job;
+    std::chrono::milliseconds period;
+    void (*run)(void *context);
+    void *context;
+    // Start of the previous run, the next one is due a period later. LVGL schedules a timer's next run relative to
+    // the start of its previous one as well.
+    std::chrono::steady_clock::time_point last_start;
+};
+
+static std::array<UiJob, Jobs::COUNT> ui_jobs;
+
+lv_timer_t *addUiJob(Job job, std::chrono::milliseconds period, void (*run)(void *context), void *context) {
+    auto &ui_job = ui_jobs[Jobs::index(job)];
+    ui_job = {.job = job,
+              .period = period,
+              .run = run,
+              .context = context,
+              .last_start = std::chrono::steady_clock::now()};
+    return lv_timer_create(
+        [](lv_timer_t *timer) {
+            auto &ui_job = *static_cast<UiJob *>(lv_timer_get_user_data(timer));
+            const auto start = std::chrono::steady_clock::now();
+            job_stats[Jobs::index(ui_job.job)].record(ui_job.last_start + ui_job.period, start);
+            ui_job.last_start = start;
+            // The LVGL task holds the UI lock already, the guards taken by the job don't wait for anybody and would
+            // only dilute `ui_lock_stats`
+            ui_lock_depth++;
+            ui_job.run(ui_job.context);
+            ui_lock_depth--;
+        },
+        static_cast<uint32_t>(period.count()), &ui_job);
+}
+
+} // namespace AppScheduler
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "lvgl.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Periodic work of the app. UI jobs run as `lv_timer`s in the LVGL task, which holds the UI lock already, so they
+// neither wait for a render nor hold up anybody else's timers. Fetching the departures runs in the refresher task,
+// which is woken up by a one-shot `esp_timer`.
+enum class Job : uint8_t {
+    // Applies the boards published by the refresher
+    BoardPoll,
+    Countdowns,
+    LastUpdated,
+    DeparturesRefresh,
+};
+
+namespace Jobs {
+// Indexed by `Job`
+inline constexpr const char *NAMES[] = {"board_poll", "countdowns", "last_updated", "departures_refresh"};
+inline constexpr size_t COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+constexpr size_t index(Job job) { return static_cast<size_t>(job); }
+
+constexpr const char *name(Job job) { return NAMES[index(job)]; }
+
+static_assert(COUNT == index(Job::DeparturesRefresh) + 1, "NAMES must have one entry per Job");
+} // namespace Jobs
+
+// How punctually a job runs, exposed via `/api/sysinfo`
+struct JobStats {
+    std::atomic<uint32_t> runs{0};
+    // How long after it was due the job started
+    std::atomic<uint32_t> last_lateness_us{0};
+    std::atomic<uint32_t> max_lateness_us{0};
+    // Smoothed difference in lateness between consecutive runs, like the interarrival jitter of RFC 3550
+    std::atomic<uint32_t> jitter_us{0};
+
+    // Only called by the task that runs the job
+    void record(std::chrono::steady_clock::time_point due, std::chrono::steady_clock::time_point started);
+};
+
+inline std::array<JobStats, Jobs::COUNT> job_stats;
+
+namespace AppScheduler {
+// Runs `run(context)` every `period` in the LVGL task and records its timing in `job_stats`. Needs the UI lock.
+lv_timer_t *addUiJob(Job job, std::chrono::milliseconds period, void (*run)(void *context), void *context = nullptr);
+} // namespace AppScheduler
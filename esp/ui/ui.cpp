@@ -1,6 +1,14 @@
 #include "ui.hpp"
 #include <algorithm>
-#include <vector>
+#include <cstdio>
+#include <cstring>
+
+#include "alloc_tracker.hpp"
+#include "latency_probes.hpp"
+
+#ifdef ESP_PLATFORM
+#include <esp_system.h>
+#endif
 
 namespace Color {
 const lv_color_t black = lv_color_hex(0x000000);
@@ -14,7 +22,52 @@ const lv_color_t purple = lv_color_hex(0x993399);   // bus
 const lv_color_t tram_red = lv_color_hex(0xcc0000); // tram
 } // namespace Color
 
+// Indexed by `Product`
+static const lv_color_t PRODUCT_COLORS[Products::COUNT_WITH_UNKNOWN] = {
+    Color::green,    // suburban
+    Color::blue,     // subway
+    Color::tram_red, // tram
+    Color::purple,   // bus
+    Color::blue,     // ferry, same as subway for now
+    Color::db_red,   // express
+    Color::db_red,   // regional
+    Color::black,    // unknown
+};
+
 static constexpr lv_style_selector_t DEFAULT_SELECTOR = (uint32_t)LV_PART_MAIN | (uint32_t)LV_STATE_DEFAULT;
+// Marks the message labels added by `DeparturesScreen::addTextItem`
+static constexpr lv_obj_flag_t TEXT_ITEM_FLAG = LV_OBJ_FLAG_USER_1;
+// How often the LVGL task checks for a newly published board
+static constexpr auto BOARD_POLL_PERIOD = std::chrono::milliseconds(50);
+// `refreshCountdowns` returns right away until a countdown changes, so this only bounds how late that shows
+static constexpr auto COUNTDOWNS_PERIOD = std::chrono::milliseconds(500);
+static constexpr auto LAST_UPDATED_PERIOD = std::chrono::milliseconds(500);
+
+// Countdown texts "Now", "1'", ..., "99'", so that refreshing a countdown doesn't have to format anything
+static constexpr int32_t COUNTDOWN_TEXT_COUNT = 100;
+static constexpr auto COUNTDOWN_TEXTS = [] {
+    std::array<std::array<char, 4>, COUNTDOWN_TEXT_COUNT> texts{};
+    texts[0] = {'N', 'o', 'w', '\0'};
+    for (int32_t minutes = 1; minutes < COUNTDOWN_TEXT_COUNT; minutes++) {
+        auto *text = texts[minutes].data();
+        if (minutes >= 10) {
+            *text++ = static_cast<char>('0' + minutes / 10);
+        }
+        *text++ = static_cast<char>('0' + minutes % 10);
+        *text++ = '\'';
+        *text = '\0';
+    }
+    return texts;
+}();
+
+// Writes the countdown shown for `minutes` left to `buffer`
+static void format_countdown(int32_t minutes, char (&buffer)[COUNTDOWN_TEXT_SIZE]) {
+    if (minutes < COUNTDOWN_TEXT_COUNT) {
+        std::memcpy(buffer, COUNTDOWN_TEXTS[minutes].data(), sizeof(COUNTDOWN_TEXTS[minutes]));
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%d'", static_cast<int>(minutes));
+    }
+}
 
 // Helper functions
 static void setup_flex_container(lv_obj_t *obj, lv_flex_flow_t flow, lv_flex_align_t main_align = LV_FLEX_ALIGN_START,
@@ -24,20 +77,206 @@ static void setup_flex_container(lv_obj_t *obj, lv_flex_flow_t flow, lv_flex_ali
     lv_obj_set_flex_align(obj, main_align, cross_align, track_align);
 }
 
+// Used to tell how much memory widgets take, not available in the simulator
+static size_t free_heap() {
+#ifdef ESP_PLATFORM
+    return esp_get_free_heap_size();
+#else
+    return 0;
+#endif
+}
+
+// Styles shared by every departure row, the header and the message labels. An object only references these, instead of
+// carrying its own copy of each property as `lv_obj_set_style_*` does.
+namespace Style {
+static lv_style_t row;
+static lv_style_t line_badge;
+// Indexed by `Product`, added on top of `line_badge`
+static lv_style_t line_badge_colors[Products::COUNT_WITH_UNKNOWN];
+static lv_style_t line;
+static lv_style_t direction;
+static lv_style_t time;
+static lv_style_t strikethrough;
+static lv_style_t header;
+static lv_style_t text_item;
+static lv_style_t table;
+} // namespace Style
+
+// Must run before any of the styles is used, with the UI lock held
+static void init_styles() {
+    static bool initialized = false;
+    if (initialized) {
+        return;
+    }
+    initialized = true;
+
+    lv_style_init(&Style::row);
+    lv_style_set_width(&Style::row, lv_pct(100));
+    lv_style_set_height(&Style::row, LV_SIZE_CONTENT);
+    lv_style_set_bg_opa(&Style::row, LV_OPA_0);
+    lv_style_set_border_width(&Style::row, 0);
+    lv_style_set_pad_top(&Style::row, 2);
+    lv_style_set_pad_bottom(&Style::row, 2);
+    lv_style_set_pad_left(&Style::row, 2);
+    lv_style_set_pad_right(&Style::row, 8);
+    lv_style_set_text_color(&Style::row, Color::black);
+    lv_style_set_text_font(&Style::row, &roboto_condensed_regular_28_4bpp);
+    lv_style_set_layout(&Style::row, LV_LAYOUT_FLEX);
+    lv_style_set_flex_flow(&Style::row, LV_FLEX_FLOW_ROW);
+    lv_style_set_flex_main_place(&Style::row, LV_FLEX_ALIGN_START);
+    lv_style_set_flex_cross_place(&Style::row, LV_FLEX_ALIGN_CENTER);
+    lv_style_set_flex_track_place(&Style::row, LV_FLEX_ALIGN_START);
+
+    // Fixed width, so that the directions line up
+    lv_style_init(&Style::line_badge);
+    lv_style_set_width(&Style::line_badge, 60);
+    lv_style_set_height(&Style::line_badge, 30);
+    lv_style_set_radius(&Style::line_badge, 5);
+    lv_style_set_border_width(&Style::line_badge, 0);
+    lv_style_set_pad_all(&Style::line_badge, 0);
+
+    for (size_t i = 0; i < Products::COUNT_WITH_UNKNOWN; i++) {
+        lv_style_init(&Style::line_badge_colors[i]);
+        lv_style_set_bg_color(&Style::line_badge_colors[i], PRODUCT_COLORS[i]);
+    }
+
+    lv_style_init(&Style::line);
+    lv_style_set_align(&Style::line, LV_ALIGN_CENTER);
+    lv_style_set_text_color(&Style::line, Color::white);
+    lv_style_set_text_font(&Style::line, &roboto_condensed_regular_28_4bpp);
+
+    // Takes the remaining space. Ideally the height would be "one line", but there's no such thing, the value is
+    // guessed visually. The padding keeps it away from the line badge (60px line + 9px padding = 69px, matching the
+    // header).
+    lv_style_init(&Style::direction);
+    lv_style_set_height(&Style::direction, 33);
+    lv_style_set_flex_grow(&Style::direction, 1);
+    lv_style_set_pad_left(&Style::direction, 9);
+    lv_style_set_text_font(&Style::direction, &roboto_condensed_light_28_4bpp);
+
+    lv_style_init(&Style::time);
+    lv_style_set_text_align(&Style::time, LV_TEXT_ALIGN_RIGHT);
+
+    // Positioned absolutely to avoid flexbox interference
+    lv_style_init(&Style::strikethrough);
+    lv_style_set_width(&Style::strikethrough, lv_pct(100));
+    lv_style_set_height(&Style::strikethrough, 2);
+    lv_style_set_x(&Style::strikethrough, 0);
+    lv_style_set_y(&Style::strikethrough, 16);
+    lv_style_set_bg_color(&Style::strikethrough, Color::black);
+    lv_style_set_radius(&Style::strikethrough, 0);
+    lv_style_set_border_width(&Style::strikethrough, 0);
+    lv_style_set_pad_all(&Style::strikethrough, 0);
+
+    lv_style_init(&Style::header);
+    lv_style_set_width(&Style::header, lv_pct(100));
+    lv_style_set_height(&Style::header, 35);
+    lv_style_set_bg_color(&Style::header, Color::black);
+    lv_style_set_text_font(&Style::header, &roboto_condensed_light_28_4bpp);
+    lv_style_set_text_color(&Style::header, Color::white);
+    lv_style_set_border_width(&Style::header, 0);
+    lv_style_set_pad_left(&Style::header, 12);
+    lv_style_set_pad_right(&Style::header, 15);
+    lv_style_set_flex_grow(&Style::header, 0);
+    lv_style_set_layout(&Style::header, LV_LAYOUT_FLEX);
+    lv_style_set_flex_flow(&Style::header, LV_FLEX_FLOW_ROW);
+    lv_style_set_flex_main_place(&Style::header, LV_FLEX_ALIGN_CENTER);
+    lv_style_set_flex_cross_place(&Style::header, LV_FLEX_ALIGN_CENTER);
+    lv_style_set_flex_track_place(&Style::header, LV_FLEX_ALIGN_CENTER);
+
+    lv_style_init(&Style::text_item);
+    lv_style_set_width(&Style::text_item, lv_pct(100));
+    lv_style_set_align(&Style::text_item, LV_ALIGN_CENTER);
+    lv_style_set_text_font(&Style::text_item, &roboto_condensed_light_28_4bpp);
+    lv_style_set_text_color(&Style::text_item, Color::black);
+
+    // Fills the panel below any message labels and scrolls on its own
+    lv_style_init(&Style::table);
+    lv_style_set_width(&Style::table, lv_pct(100));
+    lv_style_set_flex_grow(&Style::table, 1);
+    lv_style_set_bg_opa(&Style::table, LV_OPA_0);
+    lv_style_set_radius(&Style::table, 0);
+    lv_style_set_border_width(&Style::table, 0);
+    lv_style_set_pad_all(&Style::table, 0);
+}
+
+// `lv_label_set_text` redraws the label even if the text stays the same
+static void set_label_text(lv_obj_t *label, const char *text) {
+    if (std::strcmp(lv_label_get_text(label), text) != 0) {
+        lv_label_set_text(label, text);
+    }
+}
+
+// Adding or removing `LV_OBJ_FLAG_HIDDEN` redraws the object even if the flag was set already
+static void set_hidden(lv_obj_t *object, bool hidden) {
+    if (lv_obj_has_flag(object, LV_OBJ_FLAG_HIDDEN) == hidden) {
+        return;
+    }
+    if (hidden) {
+        lv_obj_add_flag(object, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_clear_flag(object, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+// See `RenderStats`, only touched from within the LVGL task or with the UI lock held
+static uint32_t board_invalidated_pixels = 0;
+static bool counting_board_pixels = false;
+static uint32_t frame_invalidated_pixels = 0;
+static std::chrono::steady_clock::time_point frame_start;
+
+static void count_invalidated_pixels(lv_event_t *e) {
+    const auto pixels = lv_area_get_size(static_cast<const lv_area_t *>(lv_event_get_param(e)));
+    frame_invalidated_pixels += pixels;
+    if (counting_board_pixels) {
+        board_invalidated_pixels += pixels;
+    }
+}
+
+static void start_frame(lv_event_t *) { frame_start = std::chrono::steady_clock::now(); }
+
+// Everything invalidated so far has been rendered and flushed
+static void finish_frame(lv_event_t *) {
+    // LVGL starts a refresh cycle every `LV_DEF_REFR_PERIOD`, most of them have nothing to do
+    if (frame_invalidated_pixels > 0) {
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                                    frame_start);
+        const auto frame_us = static_cast<uint32_t>(duration.count());
+        render_stats.frames++;
+        render_stats.last_frame_us = frame_us;
+        if (frame_invalidated_pixels >= render_stats.screen_pixels) {
+            render_stats.last_full_redraw_us = frame_us;
+        }
+        if (counting_board_pixels) {
+            LatencyProbes::recordUs(RefreshStage::Render, frame_us);
+        }
+        frame_invalidated_pixels = 0;
+    }
+
+    // The board is on screen now, and whatever is invalidated from here on isn't caused by it
+    if (counting_board_pixels) {
+        counting_board_pixels = false;
+        render_stats.last_refresh_invalidated_pixels = board_invalidated_pixels;
+    }
+}
+
 static void remove_borders_and_padding(lv_obj_t *obj) {
     lv_obj_set_style_radius(obj, 0, DEFAULT_SELECTOR);
     lv_obj_set_style_border_width(obj, 0, DEFAULT_SELECTOR);
     lv_obj_set_style_pad_all(obj, 0, DEFAULT_SELECTOR);
 }
 
-void Screen::switchTo(lv_scr_load_anim_t anim_type, uint32_t time, uint32_t delay) {
+void Screen::switchTo(lv_scr_load_anim_t anim_type, uint32_t time, uint32_t delay, bool auto_delete) {
     if (screen == nullptr) {
         this->init();
     }
 
     {
         const ui_lock_guard lock;
-        lv_scr_load_anim(screen, anim_type, time, delay, true);
+        if (lv_scr_act() == screen) {
+            return;
+        }
+        lv_scr_load_anim(screen, anim_type, time, delay, auto_delete);
     }
 }
 
@@ -131,131 +370,363 @@ void ProvisioningScreen::addQRCode(const std::string &data, const int size) {
     lv_obj_scroll_to_y(panel, LV_COORD_MAX, LV_ANIM_OFF);
 };
 
-lv_color_t DepartureItem::getProductColor(const std::string &product_type) {
-    if (product_type == "bus") {
-        return Color::purple;
-    } else if (product_type == "tram") {
-        return Color::tram_red;
-    } else if (product_type == "suburban") {
-        return Color::green;
-    } else if (product_type == "subway") {
-        return Color::blue;
-    } else if (product_type == "ferry") {
-        return Color::blue; // Same as subway for now
-    } else if (product_type == "express" || product_type == "regional") {
-        return Color::db_red;
-    }
-    return Color::black; // Default fallback
-}
-
-void DepartureItem::create(lv_obj_t *parent, const std::string &line_text, const std::string &direction_text,
-                           const std::string &time_text, const std::chrono::seconds &time_to_departure,
-                           const std::string &product_type, bool is_cancelled) {
+void DepartureItem::create(lv_obj_t *parent) {
     const ui_lock_guard lock;
-    departure_time = time_to_departure;
+    init_styles();
 
     item = lv_obj_create(parent);
-    lv_obj_set_size(item, lv_pct(100), LV_SIZE_CONTENT);
-    lv_obj_set_style_bg_opa(item, LV_OPA_0, DEFAULT_SELECTOR);
-    lv_obj_set_style_border_width(item, 0, DEFAULT_SELECTOR);
-    lv_obj_set_style_pad_top(item, 2, DEFAULT_SELECTOR);
-    lv_obj_set_style_pad_bottom(item, 2, DEFAULT_SELECTOR);
-    lv_obj_set_style_pad_left(item, 2, DEFAULT_SELECTOR);
-    lv_obj_set_style_pad_right(item, 8, DEFAULT_SELECTOR);
-    lv_obj_set_style_text_color(item, Color::black, DEFAULT_SELECTOR);
-    lv_obj_set_style_text_font(item, &roboto_condensed_regular_28_4bpp, DEFAULT_SELECTOR);
-    setup_flex_container(item, LV_FLEX_FLOW_ROW, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER);
-
-    // Create colored badge for line (fixed width)
-    lv_obj_t *line_badge = lv_obj_create(item);
-    lv_obj_set_size(line_badge, 60, 30);
+    lv_obj_add_flag(item, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_add_style(item, &Style::row, DEFAULT_SELECTOR);
+
+    // The product color is added by `bind`
+    line_badge = lv_obj_create(item);
     lv_obj_set_scroll_dir(line_badge, LV_DIR_NONE);
-    lv_obj_set_style_radius(line_badge, 5, DEFAULT_SELECTOR);
-    lv_obj_set_style_border_width(line_badge, 0, DEFAULT_SELECTOR);
-    lv_obj_set_style_pad_all(line_badge, 0, DEFAULT_SELECTOR);
-    lv_obj_set_style_bg_color(line_badge, getProductColor(product_type), DEFAULT_SELECTOR);
+    lv_obj_add_style(line_badge, &Style::line_badge, DEFAULT_SELECTOR);
 
     line = lv_label_create(line_badge);
-    lv_obj_center(line);
-    lv_label_set_text(line, line_text.c_str());
-    lv_obj_set_style_text_color(line, Color::white, DEFAULT_SELECTOR);
-    lv_obj_set_style_text_font(line, &roboto_condensed_regular_28_4bpp, DEFAULT_SELECTOR);
+    lv_obj_add_style(line, &Style::line, DEFAULT_SELECTOR);
 
-    // Direction takes remaining space
     direction = lv_label_create(item);
-    lv_obj_set_height(direction,
-                      33); // ideally we'd specify "one line" here but we can't, the value is guessed visually
-    lv_obj_set_style_flex_grow(direction, 1, DEFAULT_SELECTOR);
-    lv_obj_set_style_pad_left(
-        direction, 9,
-        DEFAULT_SELECTOR); // Add spacing from line badge (60px line + 9px padding = 69px, matching header)
     lv_label_set_long_mode(direction, LV_LABEL_LONG_DOT);
-    lv_label_set_text(direction, direction_text.c_str());
-    lv_obj_set_style_text_font(direction, &roboto_condensed_light_28_4bpp, DEFAULT_SELECTOR);
+    lv_obj_add_style(direction, &Style::direction, DEFAULT_SELECTOR);
 
-    // Time column (fixed width, right-aligned)
     time = lv_label_create(item);
-    lv_label_set_text(time, time_text.c_str());
-    lv_obj_set_style_text_align(time, LV_TEXT_ALIGN_RIGHT, DEFAULT_SELECTOR);
+    lv_obj_add_style(time, &Style::time, DEFAULT_SELECTOR);
 
-    applyStrikethroughStyle(is_cancelled);
+    // Strikethrough line for cancelled departures, kept out of the flex layout so it doesn't interfere
+    strikethrough_line = lv_obj_create(item);
+    lv_obj_add_style(strikethrough_line, &Style::strikethrough, DEFAULT_SELECTOR);
+    lv_obj_add_flag(strikethrough_line, LV_OBJ_FLAG_IGNORE_LAYOUT);
+    lv_obj_add_flag(strikethrough_line, LV_OBJ_FLAG_HIDDEN);
 }
 
-void DepartureItem::update(const std::string &line_text, const std::string &direction_text,
-                           const std::string &time_text, const std::chrono::seconds &time_to_departure,
-                           const std::string &product_type, bool is_cancelled) {
+void DepartureItem::bind(const char *line_text, const char *direction_text,
+                         std::chrono::system_clock::time_point departure_time, Product product_type,
+                         bool is_cancelled) {
     if (item == nullptr) {
         return;
     }
 
     const ui_lock_guard lock;
-    departure_time = time_to_departure;
-    lv_label_set_text(time, time_text.c_str());
+    this->departure_time = departure_time;
+    // Typically only the departure time changed, everything else is left alone
+    setBadgeColor(product_type);
+    set_label_text(line, line_text);
+    set_label_text(direction, direction_text);
+    refreshCountdown(std::chrono::system_clock::now());
     applyStrikethroughStyle(is_cancelled);
+    set_hidden(item, false);
 }
 
-void DepartureItem::destroy() {
+void DepartureItem::setBadgeColor(Product product_type) {
+    auto *color = &Style::line_badge_colors[Products::index(product_type)];
+    if (color == badge_color) {
+        return;
+    }
+
+    if (badge_color == nullptr) {
+        lv_obj_add_style(line_badge, color, DEFAULT_SELECTOR);
+    } else {
+        lv_obj_replace_style(line_badge, badge_color, color, DEFAULT_SELECTOR);
+    }
+    badge_color = color;
+}
+
+void DepartureItem::unbind() {
     if (item == nullptr) {
         return;
     }
 
     const ui_lock_guard lock;
-    lv_obj_del(item);
-    item = nullptr;
-    line = nullptr;
-    direction = nullptr;
-    time = nullptr;
-    strikethrough_line = nullptr;
+    set_hidden(item, true);
+    // Whatever departure is bound next, its countdown has to be written
+    displayed_minutes.reset();
+}
+
+void DepartureItem::refreshCountdown(std::chrono::system_clock::time_point now) {
+    if (time == nullptr) {
+        return;
+    }
+
+    // Truncated, so a departure 59 s away shows as "Now"
+    const auto time_left = std::chrono::duration_cast<std::chrono::minutes>(departure_time - now);
+    const auto minutes = std::max<int64_t>(time_left.count(), 0);
+    if (displayed_minutes == minutes) {
+        return;
+    }
+
+    const ui_lock_guard lock;
+    displayed_minutes = minutes;
+    format_countdown(static_cast<int32_t>(minutes), countdown);
+    lv_label_set_text_static(time, countdown);
+}
+
+std::chrono::system_clock::time_point DepartureItem::nextCountdownChange() const {
+    // "N'" turns into "N-1'" once less than N full minutes are left
+    return departure_time - std::chrono::minutes(displayed_minutes.value_or(0));
 }
 
 void DepartureItem::applyStrikethroughStyle(bool enable) {
-    if (item == nullptr) {
+    if (strikethrough_line == nullptr) {
         return;
     }
 
     const ui_lock_guard lock;
+    set_hidden(strikethrough_line, !enable);
+}
+
+void DepartureTable::create(lv_obj_t *parent) {
+    const ui_lock_guard lock;
+    init_styles();
+
+    object = lv_obj_create(parent);
+    lv_obj_add_style(object, &Style::table, DEFAULT_SELECTOR);
+    lv_obj_set_scroll_dir(object, LV_DIR_VER);
+    lv_obj_add_event_cb(
+        object,
+        [](lv_event_t *e) {
+            static_cast<DepartureTable *>(lv_event_get_user_data(e))->draw(lv_event_get_layer(e));
+        },
+        LV_EVENT_DRAW_MAIN, this);
+    // Lets LVGL know how far the rows can be scrolled
+    lv_obj_add_event_cb(
+        object,
+        [](lv_event_t *e) {
+            const auto *table = static_cast<DepartureTable *>(lv_event_get_user_data(e));
+            auto *size = static_cast<lv_point_t *>(lv_event_get_param(e));
+            const auto height = static_cast<int32_t>(table->row_count) * ROW_PITCH - ROW_GAP;
+            size->y = std::max(size->y, height);
+        },
+        LV_EVENT_GET_SELF_SIZE, this);
+}
 
-    if (enable) {
-        if (strikethrough_line == nullptr) {
-            // Create the strikethrough line - position it absolutely to avoid flexbox interference
-            strikethrough_line = lv_obj_create(item);
-            lv_obj_set_size(strikethrough_line, lv_pct(100), 2);
-            lv_obj_set_pos(strikethrough_line, 0, 16);
-            lv_obj_set_style_bg_color(strikethrough_line, Color::black, DEFAULT_SELECTOR);
-            remove_borders_and_padding(strikethrough_line);
-            // Remove from flex layout so it doesn't interfere
-            lv_obj_add_flag(strikethrough_line, LV_OBJ_FLAG_IGNORE_LAYOUT);
-        } else {
-            // Show existing line and update position
-            lv_obj_clear_flag(strikethrough_line, LV_OBJ_FLAG_HIDDEN);
-            lv_obj_set_pos(strikethrough_line, 0, 16);
+void DepartureTable::apply(const Board &board) {
+    if (object == nullptr) {
+        return;
+    }
+
+    const ui_lock_guard lock;
+    const auto now = std::chrono::system_clock::now();
+    const auto previous_count = row_count;
+    for (size_t i = 0; i < board.row_count; i++) {
+        if (i < previous_count && sameContent(rows[i], board.rows[i])) {
+            continue;
         }
-    } else {
-        if (strikethrough_line != nullptr) {
-            // Hide the line
-            lv_obj_add_flag(strikethrough_line, LV_OBJ_FLAG_HIDDEN);
+        bindRow(rows[i], board.rows[i], now);
+        invalidateRows(i, i + 1);
+    }
+    if (board.row_count < previous_count) {
+        invalidateRows(board.row_count, previous_count);
+    }
+
+    row_count = board.row_count;
+    if (row_count != previous_count) {
+        lv_obj_readjust_scroll(object, LV_ANIM_OFF);
+        lv_obj_scrollbar_invalidate(object);
+    }
+}
+
+std::chrono::system_clock::time_point DepartureTable::refreshCountdowns(std::chrono::system_clock::time_point now,
+                                                                        std::chrono::seconds minimum) {
+    auto next_change = std::chrono::system_clock::time_point::max();
+    if (object == nullptr) {
+        return next_change;
+    }
+
+    const ui_lock_guard lock;
+    size_t kept = 0;
+    auto first_removed = row_count;
+    for (size_t i = 0; i < row_count; i++) {
+        // Leaving sooner than the configured minimum, or already gone
+        const auto removal_time = rows[i].departure_time - minimum;
+        if (now > removal_time) {
+            first_removed = std::min(first_removed, i);
+            continue;
+        }
+
+        if (kept != i) {
+            // Everything from the first removed row on is invalidated below anyway
+            rows[kept] = rows[i];
+            updateCountdown(rows[kept], now);
+        } else if (updateCountdown(rows[kept], now)) {
+            invalidateRows(kept, kept + 1);
+        }
+        // "N'" turns into "N-1'" once less than N full minutes are left
+        const auto countdown_change = rows[kept].departure_time - std::chrono::minutes(rows[kept].displayed_minutes);
+        next_change = std::min({next_change, removal_time, countdown_change});
+        kept++;
+    }
+
+    if (kept != row_count) {
+        // Rows below a removed one move up
+        invalidateRows(first_removed, row_count);
+        row_count = kept;
+        lv_obj_readjust_scroll(object, LV_ANIM_OFF);
+        lv_obj_scrollbar_invalidate(object);
+    }
+    return next_change;
+}
+
+void DepartureTable::clear() {
+    if (object == nullptr) {
+        return;
+    }
+
+    const ui_lock_guard lock;
+    invalidateRows(0, row_count);
+    row_count = 0;
+    lv_obj_readjust_scroll(object, LV_ANIM_OFF);
+    lv_obj_scrollbar_invalidate(object);
+}
+
+void DepartureTable::bindRow(Row &row, const BoardRow &board_row, std::chrono::system_clock::time_point now) {
+    row.trip_hash = board_row.trip_hash;
+    row.departure_time = board_row.departure_time;
+    std::memcpy(row.line, board_row.line, sizeof(row.line));
+    std::memcpy(row.direction, board_row.direction, sizeof(row.direction));
+    row.product = board_row.product;
+    row.is_cancelled = board_row.is_cancelled;
+    row.fitted_width = -1;
+    row.displayed_minutes = -1;
+    updateCountdown(row, now);
+}
+
+bool DepartureTable::updateCountdown(Row &row, std::chrono::system_clock::time_point now) {
+    // Truncated, so a departure 59 s away shows as "Now"
+    const auto time_left = std::chrono::duration_cast<std::chrono::minutes>(row.departure_time - now);
+    const auto minutes = static_cast<int32_t>(std::max<int64_t>(time_left.count(), 0));
+    if (row.displayed_minutes == minutes) {
+        return false;
+    }
+
+    row.displayed_minutes = minutes;
+    format_countdown(minutes, row.countdown);
+    row.countdown_width = lv_text_get_width(row.countdown, std::strlen(row.countdown),
+                                            &roboto_condensed_regular_28_4bpp, 0);
+    // The direction gets the space the countdown doesn't take
+    row.fitted_width = -1;
+    return true;
+}
+
+void DepartureTable::fitDirection(Row &row, int32_t width) {
+    if (row.fitted_width == width) {
+        return;
+    }
+
+    row.fitted_width = width;
+    const auto *font = &roboto_condensed_light_28_4bpp;
+    auto length = std::strlen(row.direction);
+    if (lv_text_get_width(row.direction, length, font, 0) <= width) {
+        std::memcpy(row.shown_direction, row.direction, length + 1);
+        return;
+    }
+
+    // Same as `LV_LABEL_LONG_DOT`, drop characters until the rest and the dots fit
+    const auto dots_width = lv_text_get_width("...", 3, font, 0);
+    while (length > 0 && lv_text_get_width(row.direction, length, font, 0) + dots_width > width) {
+        length--;
+        // Don't cut UTF-8 sequences in half
+        while (length > 0 && (static_cast<uint8_t>(row.direction[length]) & 0xC0) == 0x80) {
+            length--;
         }
     }
+    std::memcpy(row.shown_direction, row.direction, length);
+    std::strcpy(row.shown_direction + length, "...");
+}
+
+bool DepartureTable::sameContent(const Row &row, const BoardRow &board_row) {
+    return row.trip_hash == board_row.trip_hash && row.departure_time == board_row.departure_time &&
+           row.product == board_row.product && row.is_cancelled == board_row.is_cancelled &&
+           std::strcmp(row.line, board_row.line) == 0 && std::strcmp(row.direction, board_row.direction) == 0;
+}
+
+lv_area_t DepartureTable::rowArea(size_t index) const {
+    lv_area_t area;
+    lv_obj_get_content_coords(object, &area);
+    area.y1 += static_cast<int32_t>(index) * ROW_PITCH - lv_obj_get_scroll_y(object);
+    area.y2 = area.y1 + ROW_HEIGHT - 1;
+    return area;
+}
+
+void DepartureTable::invalidateRows(size_t first, size_t end) {
+    for (size_t i = first; i < end; i++) {
+        const auto area = rowArea(i);
+        lv_obj_invalidate_area(object, &area);
+    }
+}
+
+void DepartureTable::draw(lv_layer_t *layer) {
+    lv_area_t content;
+    lv_obj_get_content_coords(object, &content);
+    const auto scroll_y = lv_obj_get_scroll_y(object);
+
+    // Only the rows scrolled into view
+    const auto first = static_cast<size_t>(std::max<int32_t>(scroll_y / ROW_PITCH, 0));
+    const auto end = std::min(static_cast<size_t>(std::max<int32_t>(
+                                  (scroll_y + lv_area_get_height(&content)) / ROW_PITCH + 1, 0)),
+                              row_count);
+    for (size_t i = first; i < end; i++) {
+        drawRow(layer, rows[i], rowArea(i));
+    }
+}
+
+void DepartureTable::drawRow(lv_layer_t *layer, Row &row, const lv_area_t &area) {
+    // Paddings and sizes of `Style::row`, `Style::line_badge` and `Style::direction`
+    const int32_t left = area.x1 + 2;
+    const int32_t right = area.x2 - 8;
+    const int32_t center_y = area.y1 + ROW_HEIGHT / 2;
+    const auto *regular_font = &roboto_condensed_regular_28_4bpp;
+    const auto *light_font = &roboto_condensed_light_28_4bpp;
+    const auto regular_top = center_y - lv_font_get_line_height(regular_font) / 2;
+    const auto light_top = center_y - lv_font_get_line_height(light_font) / 2;
+
+    lv_draw_rect_dsc_t badge;
+    lv_draw_rect_dsc_init(&badge);
+    badge.bg_color = PRODUCT_COLORS[Products::index(row.product)];
+    badge.radius = 5;
+    const lv_area_t badge_area = {left, center_y - 15, left + 59, center_y + 14};
+    lv_draw_rect(layer, &badge, &badge_area);
+
+    lv_draw_label_dsc_t line;
+    lv_draw_label_dsc_init(&line);
+    line.font = regular_font;
+    line.color = Color::white;
+    line.align = LV_TEXT_ALIGN_CENTER;
+    line.text = row.line;
+    const lv_area_t line_area = {badge_area.x1, regular_top, badge_area.x2,
+                                 regular_top + lv_font_get_line_height(regular_font) - 1};
+    lv_draw_label(layer, &line, &line_area);
+
+    const auto direction_left = badge_area.x2 + 1 + 9;
+    const auto direction_right = right - row.countdown_width;
+    fitDirection(row, direction_right - direction_left);
+    lv_draw_label_dsc_t direction;
+    lv_draw_label_dsc_init(&direction);
+    direction.font = light_font;
+    direction.color = Color::black;
+    direction.text = row.shown_direction;
+    const lv_area_t direction_area = {direction_left, light_top, direction_right,
+                                      light_top + lv_font_get_line_height(light_font) - 1};
+    lv_draw_label(layer, &direction, &direction_area);
+
+    lv_draw_label_dsc_t countdown;
+    lv_draw_label_dsc_init(&countdown);
+    countdown.font = regular_font;
+    countdown.color = Color::black;
+    countdown.align = LV_TEXT_ALIGN_RIGHT;
+    countdown.text = row.countdown;
+    const lv_area_t countdown_area = {direction_right, regular_top, right,
+                                      regular_top + lv_font_get_line_height(regular_font) - 1};
+    lv_draw_label(layer, &countdown, &countdown_area);
+
+    // See `Style::strikethrough`
+    if (row.is_cancelled) {
+        lv_draw_rect_dsc_t strikethrough;
+        lv_draw_rect_dsc_init(&strikethrough);
+        strikethrough.bg_color = Color::black;
+        const lv_area_t strikethrough_area = {left, area.y1 + 2 + 16, right, area.y1 + 2 + 17};
+        lv_draw_rect(layer, &strikethrough, &strikethrough_area);
+    }
 }
 
 void DeparturesScreen::init() {
@@ -265,17 +736,11 @@ void DeparturesScreen::init() {
     setup_flex_container(screen, LV_FLEX_FLOW_COLUMN);
     lv_obj_set_style_pad_all(screen, 0, DEFAULT_SELECTOR);
 
+    init_styles();
+
     // Header with fixed height using horizontal flexbox
     header = lv_obj_create(screen);
-    lv_obj_set_size(header, lv_pct(100), 35);
-    lv_obj_set_style_bg_color(header, Color::black, DEFAULT_SELECTOR);
-    lv_obj_set_style_text_font(header, &roboto_condensed_light_28_4bpp, DEFAULT_SELECTOR);
-    lv_obj_set_style_text_color(header, Color::white, DEFAULT_SELECTOR);
-    lv_obj_set_style_border_width(header, 0, DEFAULT_SELECTOR);
-    lv_obj_set_style_pad_left(header, 12, DEFAULT_SELECTOR);
-    lv_obj_set_style_pad_right(header, 15, DEFAULT_SELECTOR);
-    lv_obj_set_style_flex_grow(header, 0, DEFAULT_SELECTOR);
-    setup_flex_container(header, LV_FLEX_FLOW_ROW, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_add_style(header, &Style::header, DEFAULT_SELECTOR);
 
     line = lv_label_create(header);
     lv_obj_set_width(line, 68);
@@ -287,7 +752,7 @@ void DeparturesScreen::init() {
 
     departure = lv_label_create(header);
     lv_label_set_text(departure, "ETD");
-    lv_obj_set_style_text_align(departure, LV_TEXT_ALIGN_RIGHT, DEFAULT_SELECTOR);
+    lv_obj_add_style(departure, &Style::time, DEFAULT_SELECTOR);
 
     // Panel takes remaining space (flex-grow)
     panel = lv_obj_create(screen);
@@ -312,41 +777,166 @@ void DeparturesScreen::init() {
     last_updated_label = lv_label_create(footer);
     lv_obj_set_align(last_updated_label, LV_ALIGN_LEFT_MID);
     lv_obj_set_x(last_updated_label, 10);
-    lv_label_set_text(last_updated_label, "Last updated: --");
+    lv_label_set_text_static(last_updated_label, last_updated_text);
     lv_obj_set_style_text_color(last_updated_label, Color::white, DEFAULT_SELECTOR);
     lv_obj_set_style_text_font(last_updated_label, &montserrat_regular_16, DEFAULT_SELECTOR);
+
+    if (USE_DEPARTURE_TABLE) {
+        departure_table.create(panel);
+    } else {
+        // Every row the board can ever show is created up front and then only re-bound, so departures coming and
+        // going don't churn the heap
+        const auto heap_before = free_heap();
+        for (size_t i = 0; i < row_pool.size(); i++) {
+            row_pool[i].create(panel);
+            free_rows[i] = static_cast<uint8_t>(i);
+        }
+        free_row_count = row_pool.size();
+        row_pool_stats.heap_bytes = static_cast<uint32_t>(heap_before - free_heap());
+    }
+
+    board_timer = AppScheduler::addUiJob(
+        Job::BoardPoll, BOARD_POLL_PERIOD,
+        [](void *context) {
+            auto *screen = static_cast<DeparturesScreen *>(context);
+            const auto *board = board_buffer.consume();
+            if (board != nullptr && board->settings_version >= screen->min_settings_version) {
+                screen->applyBoard(*board);
+            }
+        },
+        this);
+    // Also keeps the countdowns of a snapshot shown while connecting up to date
+    AppScheduler::addUiJob(
+        Job::Countdowns, COUNTDOWNS_PERIOD,
+        [](void *context) { static_cast<DeparturesScreen *>(context)->refreshCountdowns(); }, this);
+    AppScheduler::addUiJob(
+        Job::LastUpdated, LAST_UPDATED_PERIOD,
+        [](void *context) { static_cast<DeparturesScreen *>(context)->refreshLastUpdatedDisplay(); }, this);
 };
 
-void DeparturesScreen::updateDepartureItem(const std::string &trip_id, const std::string &line_text,
-                                           const std::string &direction_text,
-                                           const std::chrono::seconds &time_to_departure,
-                                           const std::string &product_type, bool is_cancelled) {
+// Moves `object` right in front of `before`, or to the end of its parent if `before` is null.
+// `lv_obj_move_to_index` takes the index after `object` was taken out of the list, hence the adjustment.
+static void moveBefore(lv_obj_t *object, lv_obj_t *before) {
+    if (before == nullptr) {
+        lv_obj_move_to_index(object, -1);
+        return;
+    }
+
+    const auto index = lv_obj_get_index(object);
+    const auto before_index = lv_obj_get_index(before);
+    lv_obj_move_to_index(object, index < before_index ? before_index - 1 : before_index);
+}
+
+void DeparturesScreen::applyBoard(const Board &board) {
     if (panel == nullptr) {
         return;
     }
 
-    const auto minutes = std::chrono::duration_cast<std::chrono::minutes>(time_to_departure).count();
-    std::string time_text = minutes <= 0 ? "Now" : std::to_string(minutes) + "'";
+    const ui_lock_guard lock;
+    const LatencyProbes::Scope apply_probe(RefreshStage::Apply);
+    const AllocTracker::Scope apply_allocations(AllocScope::Apply);
+    board_invalidated_pixels = 0;
+    counting_board_pixels = true;
+
+    // Messages like "Loading departures..." are only ever shown on their own, the first departures replace them
+    if (!hasDepartures() && board.row_count > 0) {
+        removeTextItems();
+    }
 
-    auto it = departure_items.find(trip_id);
-    if (it != departure_items.end()) {
-        // Update existing item
-        it->second.update(line_text, direction_text, time_text, time_to_departure, product_type, is_cancelled);
+    if (USE_DEPARTURE_TABLE) {
+        departure_table.apply(board);
     } else {
-        // Create new item
-        DepartureItem &item = departure_items[trip_id];
-        item.create(panel, line_text, direction_text, time_text, time_to_departure, product_type, is_cancelled);
+        applyBoardDiff(board);
     }
+
+    shown_board = board;
+    minimum_time_to_departure = board.min_time_to_departure;
+    // Make the next `refreshCountdowns` take a fresh look at all items
+    next_countdown_change = std::chrono::system_clock::time_point::min();
+    updateLastUpdatedTime(board.updated_at);
 }
 
-void DeparturesScreen::removeDepartureItem(const std::string &trip_id) {
-    auto it = departure_items.find(trip_id);
-    if (it != departure_items.end()) {
-        it->second.destroy();
-        departure_items.erase(it);
+void DeparturesScreen::applyBoardDiff(const Board &board) {
+    // Only what actually changed reaches LVGL, see `BoardDiff`
+    board_diff.compute(shown_board, board);
+    for (const auto &operation : board_diff) {
+        switch (operation.kind) {
+        case BoardOperation::Kind::Remove: {
+            const auto trip_hash = shown_board.rows[operation.row].trip_hash;
+            if (auto **row = departure_items.find(trip_hash)) {
+                releaseRow(*row);
+                departure_items.erase(trip_hash);
+            }
+            break;
+        }
+        case BoardOperation::Kind::Update: {
+            const auto &row = board.rows[operation.row];
+            if (auto **item = departure_items.find(row.trip_hash)) {
+                (*item)->bind(row.line, row.direction, row.departure_time, row.product, row.is_cancelled);
+            }
+            break;
+        }
+        case BoardOperation::Kind::Insert:
+        case BoardOperation::Kind::Move: {
+            const auto &row = board.rows[operation.row];
+            if (operation.kind == BoardOperation::Kind::Insert) {
+                // Can't fail, removals come first and the board never has more rows than the pool
+                auto *item = acquireRow();
+                if (item == nullptr) {
+                    break;
+                }
+                item->bind(row.line, row.direction, row.departure_time, row.product, row.is_cancelled);
+                *departure_items.insert(row.trip_hash) = item;
+            }
+            auto **item = departure_items.find(row.trip_hash);
+            auto **before = operation.before == BoardOperation::END
+                                ? nullptr
+                                : departure_items.find(board.rows[operation.before].trip_hash);
+            if (item != nullptr) {
+                moveBefore((*item)->getItem(), before != nullptr ? (*before)->getItem() : nullptr);
+            }
+            break;
+        }
+        }
     }
 }
 
+void DeparturesScreen::setMinimumTimeToDeparture(std::chrono::seconds minimum) {
+    const ui_lock_guard lock;
+    minimum_time_to_departure = minimum;
+    next_countdown_change = std::chrono::system_clock::time_point::min();
+}
+
+void DeparturesScreen::refreshCountdowns() {
+    const auto now = std::chrono::system_clock::now();
+    if (now <= next_countdown_change.load()) {
+        return;
+    }
+
+    const ui_lock_guard lock;
+    if (USE_DEPARTURE_TABLE) {
+        next_countdown_change = departure_table.refreshCountdowns(now, minimum_time_to_departure);
+        return;
+    }
+
+    auto next_change = std::chrono::system_clock::time_point::max();
+    departure_items.eraseIf([&](DepartureItemMap::Entry &entry) {
+        auto &item = *entry.value;
+        // Leaving sooner than the configured minimum, or already gone
+        const auto removal_time = item.getDepartureTime() - minimum_time_to_departure;
+        if (now > removal_time) {
+            releaseRow(&item);
+            shown_board.removeRow(entry.key);
+            return true;
+        }
+
+        item.refreshCountdown(now);
+        next_change = std::min({next_change, removal_time, item.nextCountdownChange()});
+        return false;
+    });
+    next_countdown_change = next_change;
+}
+
 void DeparturesScreen::addTextItem(const std::string &text) {
     if (panel == nullptr) {
         return;
@@ -355,11 +945,20 @@ void DeparturesScreen::addTextItem(const std::string &text) {
     {
         const ui_lock_guard lock;
         auto *item = lv_label_create(panel);
-        lv_obj_set_width(item, lv_pct(100));
-        lv_obj_set_align(item, LV_ALIGN_CENTER);
         lv_label_set_text(item, text.c_str());
-        lv_obj_set_style_text_font(item, &roboto_condensed_light_28_4bpp, DEFAULT_SELECTOR);
-        lv_obj_set_style_text_color(item, Color::black, DEFAULT_SELECTOR);
+        lv_obj_add_style(item, &Style::text_item, DEFAULT_SELECTOR);
+        // Tells them apart from the pooled departure rows in the same panel
+        lv_obj_add_flag(item, TEXT_ITEM_FLAG);
+    }
+}
+
+void DeparturesScreen::removeTextItems() {
+    const ui_lock_guard lock;
+    for (auto i = static_cast<int32_t>(lv_obj_get_child_count(panel)) - 1; i >= 0; i--) {
+        auto *child = lv_obj_get_child(panel, i);
+        if (lv_obj_has_flag(child, TEXT_ITEM_FLAG)) {
+            lv_obj_del(child);
+        }
     }
 }
 
@@ -369,86 +968,72 @@ void DeparturesScreen::clean() {
     }
 
     const ui_lock_guard lock;
-    lv_obj_clean(panel);
-    departure_items.clear();
+    removeTextItems();
+    cleanDepartureItems();
 };
 
 void DeparturesScreen::cleanDepartureItems() {
-    for (auto &pair : departure_items) {
-        pair.second.destroy();
+    const ui_lock_guard lock;
+    departure_table.clear();
+    for (auto &entry : departure_items) {
+        releaseRow(entry.value);
     }
     departure_items.clear();
+    shown_board.clear();
 }
 
-void DeparturesScreen::updateLastUpdatedTime() {
-    if (last_updated_label == nullptr) {
-        return;
+bool DeparturesScreen::hasDepartures() const {
+    return USE_DEPARTURE_TABLE ? departure_table.size() > 0 : !departure_items.empty();
+}
+
+DepartureItem *DeparturesScreen::acquireRow() {
+    if (free_row_count == 0) {
+        row_pool_stats.misses++;
+        return nullptr;
     }
 
-    const ui_lock_guard lock;
-    last_updated_time = std::chrono::system_clock::now();
-    lv_label_set_text(last_updated_label, "Last updated: 0s ago");
+    row_pool_stats.hits++;
+    row_pool_stats.in_use++;
+    return &row_pool[free_rows[--free_row_count]];
+}
+
+void DeparturesScreen::releaseRow(DepartureItem *row) {
+    row->unbind();
+    free_rows[free_row_count++] = static_cast<uint8_t>(row - row_pool.data());
+    row_pool_stats.in_use--;
+}
+
+void DeparturesScreen::updateLastUpdatedTime(std::chrono::system_clock::time_point time) {
+    // The label itself is rendered by `refreshLastUpdatedDisplay`, which runs periodically
+    last_updated_time = time;
 }
 
 void DeparturesScreen::refreshLastUpdatedDisplay() {
-    if (last_updated_label == nullptr || last_updated_time.time_since_epoch().count() == 0) {
+    const auto updated_at = last_updated_time.load();
+    if (last_updated_label == nullptr || updated_at.time_since_epoch().count() == 0) {
         return;
     }
 
-    const ui_lock_guard lock;
     auto now = std::chrono::system_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::seconds>(now - last_updated_time);
+    auto duration = std::chrono::duration_cast<std::chrono::seconds>(now - updated_at);
     auto seconds = duration.count();
 
-    std::string text;
+    char text[sizeof(last_updated_text)];
     if (seconds < 60) {
-        text = "Last updated: " + std::to_string(seconds) + "s ago";
+        std::snprintf(text, sizeof(text), "Last updated: %llds ago", static_cast<long long>(seconds));
     } else if (seconds < 3600) {
-        auto minutes = seconds / 60;
-        text = "Last updated: " + std::to_string(minutes) + "m ago";
+        std::snprintf(text, sizeof(text), "Last updated: %lldm ago", static_cast<long long>(seconds / 60));
     } else {
-        auto hours = seconds / 3600;
-        text = "Last updated: " + std::to_string(hours) + "h ago";
+        std::snprintf(text, sizeof(text), "Last updated: %lldh ago", static_cast<long long>(seconds / 3600));
     }
-
-    lv_label_set_text(last_updated_label, text.c_str());
-}
-
-void DeparturesScreen::reorderByDepartureTime() {
-    if (panel == nullptr || departure_items.empty()) {
+    // Mostly the same text as half a second ago
+    if (std::strcmp(text, last_updated_text) == 0) {
         return;
     }
 
     const ui_lock_guard lock;
-
-    // Create a vector of (trip_id, departure_time) pairs for sorting
-    std::vector<std::pair<std::string, std::optional<std::chrono::seconds>>> sorted_items;
-    for (const auto &[trip_id, item] : departure_items) {
-        sorted_items.emplace_back(trip_id, item.getDepartureTime());
-    }
-
-    // Sort by departure time (nullopt values go to the end)
-    std::sort(sorted_items.begin(), sorted_items.end(), [](const auto &a, const auto &b) {
-        if (!a.second && !b.second)
-            return false; // Both nullopt, maintain original order
-        if (!a.second)
-            return false; // a is nullopt, b comes first
-        if (!b.second)
-            return true;                            // b is nullopt, a comes first
-        return a.second.value() < b.second.value(); // Both have values, compare
-    });
-
-    // Reorder the LVGL objects by moving them to the correct positions
-    for (size_t i = 0; i < sorted_items.size(); ++i) {
-        const auto &trip_id = sorted_items[i].first;
-        auto it = departure_items.find(trip_id);
-        if (it != departure_items.end()) {
-            lv_obj_t *item_obj = it->second.getItem();
-            if (item_obj != nullptr) {
-                lv_obj_move_to_index(item_obj, i);
-            }
-        }
-    }
+    std::memcpy(last_updated_text, text, sizeof(text));
+    lv_label_set_text_static(last_updated_label, last_updated_text);
 }
 
 void UIManager::init() {
@@ -458,6 +1043,12 @@ void UIManager::init() {
         auto *dispp = lv_disp_get_default();
         auto *theme = lv_theme_simple_init(dispp);
         lv_disp_set_theme(dispp, theme);
+
+        render_stats.screen_pixels = static_cast<uint32_t>(lv_display_get_horizontal_resolution(dispp) *
+                                                           lv_display_get_vertical_resolution(dispp));
+        lv_display_add_event_cb(dispp, count_invalidated_pixels, LV_EVENT_INVALIDATE_AREA, nullptr);
+        lv_display_add_event_cb(dispp, start_frame, LV_EVENT_REFR_START, nullptr);
+        lv_display_add_event_cb(dispp, finish_frame, LV_EVENT_REFR_READY, nullptr);
     }
 
     splash_screen.switchTo();
@@ -1,11 +1,47 @@
 #pragma once
 
 #include "lvgl.h"
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <mutex>
 #include <optional>
 #include <string>
-#include <unordered_map>
+
+#include "app_scheduler.hpp"
+#include "board.hpp"
+#include "board_diff.hpp"
+#include "fixed_map.hpp"
+#include "product.hpp"
+
+// How long taking the UI lock had to wait, mostly for the LVGL task to finish a render. Exposed via `/api/sysinfo`.
+struct UiLockStats {
+    static constexpr auto SLOW_WAIT = std::chrono::milliseconds(1);
+
+    std::atomic<uint32_t> acquisitions{0};
+    // Acquisitions that waited for longer than `SLOW_WAIT`
+    std::atomic<uint32_t> slow_acquisitions{0};
+    std::atomic<uint64_t> total_wait_us{0};
+    std::atomic<uint32_t> max_wait_us{0};
+
+    // Called with the lock held, so never concurrently
+    void record(std::chrono::steady_clock::duration wait) {
+        const auto wait_us = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(wait).count());
+        acquisitions++;
+        if (wait > SLOW_WAIT) {
+            slow_acquisitions++;
+        }
+        total_wait_us += wait_us;
+        if (wait_us > max_wait_us) {
+            max_wait_us = wait_us;
+        }
+    }
+};
+
+inline UiLockStats ui_lock_stats;
+// Guards held by the current thread, plus one while the LVGL task runs a UI job with the lock it took itself. The lock
+// is recursive, only the outermost acquisition can wait and is recorded.
+inline thread_local uint32_t ui_lock_depth = 0;
 
 // Cross-platform LVGL mutex handling
 #ifdef ESP_PLATFORM
@@ -13,8 +49,19 @@
 
 class ui_lock_guard {
   public:
-    ui_lock_guard() { lvgl_port_lock(0); }
-    ~ui_lock_guard() { lvgl_port_unlock(); }
+    ui_lock_guard() {
+        if (ui_lock_depth++ > 0) {
+            lvgl_port_lock(0);
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        lvgl_port_lock(0);
+        ui_lock_stats.record(std::chrono::steady_clock::now() - start);
+    }
+    ~ui_lock_guard() {
+        lvgl_port_unlock();
+        ui_lock_depth--;
+    }
 };
 
 #else
@@ -23,10 +70,19 @@ inline std::recursive_mutex lvgl_mutex;
 
 class ui_lock_guard {
   public:
-    ui_lock_guard() : lock_(lvgl_mutex) {}
-
-  private:
-    std::lock_guard<std::recursive_mutex> lock_;
+    ui_lock_guard() {
+        if (ui_lock_depth++ > 0) {
+            lvgl_mutex.lock();
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        lvgl_mutex.lock();
+        ui_lock_stats.record(std::chrono::steady_clock::now() - start);
+    }
+    ~ui_lock_guard() {
+        lvgl_mutex.unlock();
+        ui_lock_depth--;
+    }
 };
 #endif
 
@@ -38,7 +94,9 @@ LV_FONT_DECLARE(montserrat_regular_72);
 
 class Screen {
   public:
-    void switchTo(lv_scr_load_anim_t anim_type = LV_SCR_LOAD_ANIM_NONE, uint32_t time = 0, uint32_t delay = 0);
+    // Unless `auto_delete` is false, the previous screen is deleted once this one is loaded
+    void switchTo(lv_scr_load_anim_t anim_type = LV_SCR_LOAD_ANIM_NONE, uint32_t time = 0, uint32_t delay = 0,
+                  bool auto_delete = true);
 
   protected:
     lv_obj_t *screen = nullptr;
@@ -81,47 +139,130 @@ class ProvisioningScreen : public Screen {
     lv_obj_t *panel = nullptr;
 };
 
+// Room for a countdown, "Now" or "N'"
+inline constexpr size_t COUNTDOWN_TEXT_SIZE = 8;
+
+// A row of the departures panel. Created once, hidden, and then bound to one departure after the other.
 class DepartureItem {
   public:
-    void create(lv_obj_t *parent, const std::string &line_text, const std::string &direction_text,
-                const std::string &time_text, const std::chrono::seconds &time_to_departure,
-                const std::string &product_type, bool is_cancelled = false);
-    void update(const std::string &line_text, const std::string &direction_text, const std::string &time_text,
-                const std::chrono::seconds &time_to_departure, const std::string &product_type,
-                bool is_cancelled = false);
-    void destroy();
+    void create(lv_obj_t *parent);
+    // Shows the departure in this row
+    void bind(const char *line_text, const char *direction_text, std::chrono::system_clock::time_point departure_time,
+              Product product_type, bool is_cancelled = false);
+    // Hides the row until it's bound again
+    void unbind();
+    // Updates the countdown label, touching LVGL only if the number of minutes changed
+    void refreshCountdown(std::chrono::system_clock::time_point now);
+    // First point in time after which `refreshCountdown` would show something else
+    std::chrono::system_clock::time_point nextCountdownChange() const;
     lv_obj_t *getItem() const { return item; }
-    std::chrono::seconds getDepartureTime() const { return departure_time; }
+    std::chrono::system_clock::time_point getDepartureTime() const { return departure_time; }
 
   private:
     lv_obj_t *item = nullptr;
+    lv_obj_t *line_badge = nullptr;
     lv_obj_t *line = nullptr;
     lv_obj_t *direction = nullptr;
     lv_obj_t *time = nullptr;
     lv_obj_t *strikethrough_line = nullptr;
-    std::chrono::seconds departure_time;
+    std::chrono::system_clock::time_point departure_time;
+    // Minutes currently shown in the countdown label, `0` stands for "Now"
+    std::optional<int64_t> displayed_minutes;
+    // Shown by `time` as static text, so that LVGL doesn't keep a copy of its own
+    char countdown[COUNTDOWN_TEXT_SIZE] = "";
+    // Shared style currently giving `line_badge` its product color
+    const lv_style_t *badge_color = nullptr;
 
     void applyStrikethroughStyle(bool enable);
-    lv_color_t getProductColor(const std::string &product_type);
+    void setBadgeColor(Product product_type);
 };
 
+// The whole departures board as a single LVGL object. Rather than building each row from a container, a badge and
+// three labels, it keeps compact row records and draws them in its draw event. Only rows that changed are
+// invalidated, and only rows scrolled into view are drawn.
+class DepartureTable {
+  public:
+    // Same geometry as the flex rows of `DepartureItem`
+    static const constexpr int32_t ROW_HEIGHT = 37;
+    static const constexpr int32_t ROW_GAP = 2;
+    static const constexpr int32_t ROW_PITCH = ROW_HEIGHT + ROW_GAP;
+
+    void create(lv_obj_t *parent);
+    // Takes over the rows of the board, invalidating those that differ from what's shown at the same position
+    void apply(const Board &board);
+    // Drops the rows leaving sooner than `minimum` and updates the countdowns. Returns the first point in time after
+    // which calling it again would change anything.
+    std::chrono::system_clock::time_point refreshCountdowns(std::chrono::system_clock::time_point now,
+                                                            std::chrono::seconds minimum);
+    void clear();
+    size_t size() const { return row_count; }
+    lv_obj_t *getObject() const { return object; }
+
+  private:
+    struct Row {
+        uint64_t trip_hash;
+        std::chrono::system_clock::time_point departure_time;
+        char line[sizeof(BoardRow::line)];
+        char direction[sizeof(BoardRow::direction)];
+        // `direction`, shortened with "..." to fit next to the countdown
+        char shown_direction[sizeof(BoardRow::direction) + 3];
+        // "Now" or "N'"
+        char countdown[COUNTDOWN_TEXT_SIZE];
+        int32_t countdown_width;
+        // Width `shown_direction` was fitted to, -1 if it has to be fitted again
+        int32_t fitted_width;
+        // -1 until the countdown was written, `0` stands for "Now"
+        int32_t displayed_minutes;
+        Product product;
+        bool is_cancelled;
+    };
+
+    lv_obj_t *object = nullptr;
+    std::array<Row, Board::MAX_ROWS> rows;
+    size_t row_count = 0;
+
+    void bindRow(Row &row, const BoardRow &board_row, std::chrono::system_clock::time_point now);
+    // Returns true if the countdown text changed
+    static bool updateCountdown(Row &row, std::chrono::system_clock::time_point now);
+    static void fitDirection(Row &row, int32_t width);
+    static bool sameContent(const Row &row, const BoardRow &board_row);
+    lv_area_t rowArea(size_t index) const;
+    void invalidateRows(size_t first, size_t end);
+    void draw(lv_layer_t *layer);
+    void drawRow(lv_layer_t *layer, Row &row, const lv_area_t &area);
+};
+
+// Draw the departures with a single `DepartureTable` instead of a flex layout of pooled `DepartureItem` rows
+#ifdef CONFIG_DEPARTURE_TABLE_WIDGET
+inline constexpr bool USE_DEPARTURE_TABLE = true;
+#else
+inline constexpr bool USE_DEPARTURE_TABLE = false;
+#endif
+
 class DeparturesScreen : public Screen {
   public:
     void init();
-    void updateDepartureItem(const std::string &trip_id, const std::string &line_text,
-                             const std::string &direction_text, const std::chrono::seconds &time_to_departure,
-                             const std::string &product_type, bool is_cancelled = false);
-    void removeDepartureItem(const std::string &trip_id);
+    // Makes the departure items match the board, touching only the items that changed
+    void applyBoard(const Board &board);
     void addTextItem(const std::string &text);
     void clean();
     void cleanDepartureItems();
-    void updateLastUpdatedTime();
+    void updateLastUpdatedTime(std::chrono::system_clock::time_point time = std::chrono::system_clock::now());
     void refreshLastUpdatedDisplay();
-    void reorderByDepartureTime();
-    const std::unordered_map<std::string, DepartureItem> &getDepartureItems() const { return departure_items; }
+    // Departures leaving sooner than this are dropped by `refreshCountdowns`
+    void setMinimumTimeToDeparture(std::chrono::seconds minimum);
+    // Recomputes the countdowns from the departure times and drops departed items, without fetching anything.
+    // Cheap to call often, it returns right away until the next countdown actually changes.
+    void refreshCountdowns();
+    // Rows of `row_pool` bound to a departure, keyed by `BoardRow::trip_hash`
+    using DepartureItemMap = FixedMap<DepartureItem *, Board::MAX_ROWS>;
+    bool hasDepartures() const;
 
     void showLoadingMessage(const std::string &station_name);
     void showStationNotFoundError();
+    // Boards built from older settings are dropped instead of applied, e.g. those of the previous station that were
+    // published or in flight when the station changed. Safe to call from any task.
+    void dropBoardsBefore(uint32_t settings_version) { min_settings_version = settings_version; }
 
   private:
     lv_obj_t *header = nullptr;
@@ -131,10 +272,65 @@ class DeparturesScreen : public Screen {
     lv_obj_t *departure = nullptr;
     lv_obj_t *panel = nullptr;
     lv_obj_t *last_updated_label = nullptr;
-    std::chrono::system_clock::time_point last_updated_time;
-    std::unordered_map<std::string, DepartureItem> departure_items;
+    // Applies the boards published to `board_buffer`, from within the LVGL task
+    lv_timer_t *board_timer = nullptr;
+    // Written by the refresher without holding the UI lock, hence atomic
+    std::atomic<std::chrono::system_clock::time_point> last_updated_time;
+    // Shown by `last_updated_label` as static text, only written by `refreshLastUpdatedDisplay`
+    char last_updated_text[32] = "Last updated: --";
+    std::array<DepartureItem, Board::MAX_ROWS> row_pool;
+    // Indices into `row_pool` of the rows not bound to a departure
+    std::array<uint8_t, Board::MAX_ROWS> free_rows;
+    size_t free_row_count = 0;
+    DepartureItemMap departure_items;
+    // Used instead of `row_pool` and `departure_items` if `USE_DEPARTURE_TABLE` is set
+    DepartureTable departure_table;
+    // What `departure_items` currently show, in order, to diff the next board against
+    Board shown_board;
+    BoardDiff board_diff;
+    std::chrono::seconds minimum_time_to_departure{0};
+    // Written by the refresher, read by the periodic countdown refresh without holding the UI lock
+    std::atomic<std::chrono::system_clock::time_point> next_countdown_change;
+    // See `dropBoardsBefore`
+    std::atomic<uint32_t> min_settings_version{0};
+
+    // Applies `board` to the pooled rows, one `BoardDiff` operation at a time
+    void applyBoardDiff(const Board &board);
+    // Returns nullptr if every row is in use
+    DepartureItem *acquireRow();
+    void releaseRow(DepartureItem *row);
+    // Deletes the labels added by `addTextItem`
+    void removeTextItems();
+};
+
+// Usage of the pooled departure rows, exposed via `/api/sysinfo`
+struct RowPoolStats {
+    // Departures bound to a pooled row
+    std::atomic<uint32_t> hits{0};
+    // Departures that couldn't be shown because every row was in use, should never happen
+    std::atomic<uint32_t> misses{0};
+    std::atomic<uint32_t> in_use{0};
+    // Heap taken by creating all rows, measured once. Always zero in the simulator.
+    std::atomic<uint32_t> heap_bytes{0};
+};
+
+// What LVGL had to redraw, exposed via `/api/sysinfo`. Every invalidated pixel ends up being sent to the display.
+struct RenderStats {
+    // From applying the last board up to the end of the render that followed it. Ideally close to zero if the
+    // departures didn't change.
+    std::atomic<uint32_t> last_refresh_invalidated_pixels{0};
+    std::atomic<uint32_t> screen_pixels{0};
+    // Refresh cycles that had anything to draw
+    std::atomic<uint32_t> frames{0};
+    // Rendering and flushing, including waiting for the display. While scrolling, every frame redraws the panel, so
+    // this is what limits the frame rate.
+    std::atomic<uint32_t> last_frame_us{0};
+    // Last frame which invalidated at least as many pixels as the screen has, e.g. after switching screens
+    std::atomic<uint32_t> last_full_redraw_us{0};
 };
 
+inline RowPoolStats row_pool_stats;
+inline RenderStats render_stats;
 inline SplashScreen splash_screen;
 inline ProvisioningScreen provisioning_screen;
 inline DeparturesScreen departures_screen;
@@ -4,6 +4,8 @@ export interface SettingsRequest {
     minDepartureMinutes?: number;
     maxDepartureCount?: number;
     showCancelledDepartures?: boolean;
+    nightStartHour?: number;
+    nightEndHour?: number;
     currentStation?: StationWithProducts;
 }
 
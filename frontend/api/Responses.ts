@@ -4,6 +4,8 @@ export interface SettingsResponse {
     minDepartureMinutes: number;
     maxDepartureCount: number;
     showCancelledDepartures: boolean;
+    nightStartHour: number;
+    nightEndHour: number;
     currentStation: StationWithProducts | null;
 }
 
@@ -30,6 +32,84 @@ export interface SysInfoMemoryResponse {
     minimum_free_heap: number;
 }
 
+export interface SysInfoRefreshResponse {
+    cycles: number;
+    failed_cycles: number;
+    skipped_cycles: number;
+    not_modified_responses: number;
+    interval_ms: number;
+    interval_reason: 'changed' | 'unchanged' | 'departure_horizon' | 'night' | 'backoff' | 'idle';
+    boot_snapshot: 'shown' | 'missing' | 'clock_not_set' | 'too_old';
+}
+
+export interface SysInfoStringPoolResponse {
+    size: number;
+    capacity: number;
+    hits: number;
+    misses: number;
+    evictions: number;
+    failures: number;
+    hit_rate: number;
+}
+
+export interface SysInfoRowPoolResponse {
+    capacity: number;
+    in_use: number;
+    hits: number;
+    misses: number;
+    heap_bytes: number;
+}
+
+export interface SysInfoRenderResponse {
+    last_refresh_invalidated_pixels: number;
+    screen_pixels: number;
+    frames: number;
+    last_frame_us: number;
+    last_full_redraw_us: number;
+}
+
+export interface SysInfoJobResponse {
+    name: 'board_poll' | 'countdowns' | 'last_updated' | 'departures_refresh';
+    runs: number;
+    last_lateness_us: number;
+    max_lateness_us: number;
+    jitter_us: number;
+}
+
+export interface SysInfoUiLockResponse {
+    acquisitions: number;
+    slow_acquisitions: number;
+    total_wait_us: number;
+    max_wait_us: number;
+}
+
+export interface SysInfoSchedulerResponse {
+    jobs: Array<SysInfoJobResponse>;
+    ui_lock: SysInfoUiLockResponse;
+}
+
+export interface SysInfoCpuWindowResponse {
+    window_s: number;
+    samples: number;
+    // Percent busy, per core
+    cores: Array<number>;
+    // Percent of one core
+    tasks: Record<'lvgl' | 'httpd' | 'refresher' | 'wifi' | 'tcpip', number>;
+}
+
+export interface SysInfoAllocationScopeResponse {
+    scope: 'fetch' | 'filter' | 'apply' | 'cycle';
+    runs: number;
+    allocation_free_runs: number;
+    // Of the most recent run
+    last_allocations: number;
+    last_frees: number;
+    last_bytes: number;
+    max_allocations: number;
+    total_allocations: number;
+    total_bytes: number;
+}
+
 export interface SysInfoTaskResponse {
     name: string;
     priority: number;
@@ -48,6 +128,13 @@ export interface SysInfoResponse {
     software: SysInfoSoftwareResponse;
     hardware: SysInfoHardwareResponse;
     memory: SysInfoMemoryResponse;
+    refresh: SysInfoRefreshResponse;
+    string_pool: SysInfoStringPoolResponse;
+    row_pool: SysInfoRowPoolResponse;
+    render: SysInfoRenderResponse;
+    scheduler: SysInfoSchedulerResponse;
+    cpu: Array<SysInfoCpuWindowResponse> | null;
+    allocations: Array<SysInfoAllocationScopeResponse> | null;
     debug: SysInfoDebugResponse;
     tasks: Array<SysInfoTaskResponse> | null;
 }
@@ -11,6 +11,8 @@ function getDefaultSettings(): SettingsResponse {
         minDepartureMinutes: 0,
         maxDepartureCount: 12,
         showCancelledDepartures: true,
+        nightStartHour: 1,
+        nightEndHour: 5,
         currentStation: null,
     };
 }
@@ -19,7 +21,7 @@ function loadSettingsFromStorage(): SettingsResponse {
     try {
         const stored = localStorage.getItem(MOCK_STORAGE_KEY);
         if (stored) {
-            return JSON.parse(stored) as SettingsResponse;
+            return { ...getDefaultSettings(), ...(JSON.parse(stored) as Partial<SettingsResponse>) };
         }
     } catch (error) {
         console.warn('Failed to load mock settings from localStorage:', error);
@@ -94,6 +96,130 @@ export const handlers = [
                 free_heap: 123456,
                 minimum_free_heap: 123456,
             },
+            refresh: {
+                cycles: 360,
+                failed_cycles: 2,
+                skipped_cycles: 120,
+                not_modified_responses: 0,
+                interval_ms: 25000,
+                interval_reason: 'unchanged',
+                boot_snapshot: 'clock_not_set',
+            },
+            string_pool: {
+                size: 34,
+                capacity: 96,
+                hits: 8506,
+                misses: 34,
+                evictions: 0,
+                failures: 0,
+                hit_rate: 0.996,
+            },
+            row_pool: {
+                capacity: 20,
+                in_use: 12,
+                hits: 1843,
+                misses: 0,
+                heap_bytes: 21480,
+            },
+            render: {
+                last_refresh_invalidated_pixels: 5760,
+                screen_pixels: 153600,
+                frames: 9312,
+                last_frame_us: 14250,
+                last_full_redraw_us: 41800,
+            },
+            scheduler: {
+                jobs: [
+                    { name: 'board_poll', runs: 72410, last_lateness_us: 1830, max_lateness_us: 38200, jitter_us: 940 },
+                    { name: 'countdowns', runs: 7241, last_lateness_us: 2410, max_lateness_us: 41100, jitter_us: 1120 },
+                    {
+                        name: 'last_updated',
+                        runs: 7241,
+                        last_lateness_us: 2390,
+                        max_lateness_us: 40800,
+                        jitter_us: 1090,
+                    },
+                    {
+                        name: 'departures_refresh',
+                        runs: 358,
+                        last_lateness_us: 310,
+                        max_lateness_us: 5200,
+                        jitter_us: 120,
+                    },
+                ],
+                ui_lock: {
+                    acquisitions: 15230,
+                    slow_acquisitions: 412,
+                    total_wait_us: 2981000,
+                    max_wait_us: 44100,
+                },
+            },
+            cpu: [
+                {
+                    window_s: 1,
+                    samples: 1,
+                    cores: [4.2, 31.5],
+                    tasks: { lvgl: 27.9, httpd: 0.4, refresher: 2.1, wifi: 1.3, tcpip: 0.8 },
+                },
+                {
+                    window_s: 10,
+                    samples: 10,
+                    cores: [3.1, 12.7],
+                    tasks: { lvgl: 9.8, httpd: 0.2, refresher: 1.4, wifi: 1.1, tcpip: 0.6 },
+                },
+                {
+                    window_s: 60,
+                    samples: 60,
+                    cores: [2.9, 6.3],
+                    tasks: { lvgl: 3.9, httpd: 0.1, refresher: 0.9, wifi: 1.0, tcpip: 0.5 },
+                },
+            ],
+            allocations: [
+                {
+                    scope: 'fetch',
+                    runs: 214,
+                    allocation_free_runs: 0,
+                    last_allocations: 183,
+                    last_frees: 164,
+                    last_bytes: 9412,
+                    max_allocations: 402,
+                    total_allocations: 41876,
+                    total_bytes: 2215630,
+                },
+                {
+                    scope: 'filter',
+                    runs: 37,
+                    allocation_free_runs: 0,
+                    last_allocations: 14,
+                    last_frees: 31,
+                    last_bytes: 1536,
+                    max_allocations: 52,
+                    total_allocations: 611,
+                    total_bytes: 70342,
+                },
+                {
+                    scope: 'apply',
+                    runs: 37,
+                    allocation_free_runs: 21,
+                    last_allocations: 0,
+                    last_frees: 0,
+                    last_bytes: 0,
+                    max_allocations: 96,
+                    total_allocations: 512,
+                    total_bytes: 48120,
+                },
+                {
+                    scope: 'cycle',
+                    runs: 214,
+                    allocation_free_runs: 0,
+                    last_allocations: 197,
+                    last_frees: 195,
+                    last_bytes: 10948,
+                    max_allocations: 455,
+                    total_allocations: 42489,
+                    total_bytes: 2285972,
+                },
+            ],
             debug: {
                 bvg_api_url: buildMockBvgUrl(currentStation, maxDepartureCount),
             },
@@ -22,6 +22,8 @@ import {
     MIN_DEPARTURE_MINUTES_MAX,
     MAX_DEPARTURE_COUNT_MIN,
     MAX_DEPARTURE_COUNT_MAX,
+    NIGHT_HOUR_MIN,
+    NIGHT_HOUR_MAX,
 } from '../../util/Constants';
 import ServicesSection from './ServicesSection';
 import StationChangeDialog from './StationChangeDialog';
@@ -62,6 +64,8 @@ export function HomeTab() {
     const [minDepartureMinutes, setMinDepartureMinutes] = useState<number | null>(null);
     const [maxDepartureCount, setMaxDepartureCount] = useState<number | null>(null);
     const [showCancelledDepartures, setShowCancelledDepartures] = useState<boolean | null>(null);
+    const [nightStartHour, setNightStartHour] = useState<number | null>(null);
+    const [nightEndHour, setNightEndHour] = useState<number | null>(null);
     const { state: snackbarState, openWithMessage: openSnackbarWithMessage, close: closeSnackbar } = useSnackbarState();
 
     // Sync local state with settings response
@@ -70,11 +74,19 @@ export function HomeTab() {
             setMinDepartureMinutes(settingsResponse.minDepartureMinutes);
             setMaxDepartureCount(settingsResponse.maxDepartureCount);
             setShowCancelledDepartures(settingsResponse.showCancelledDepartures);
+            setNightStartHour(settingsResponse.nightStartHour);
+            setNightEndHour(settingsResponse.nightEndHour);
         }
     }, [settingsResponse]);
 
     const handleSaveSettings = () => {
-        if (minDepartureMinutes === null || maxDepartureCount === null || showCancelledDepartures === null) {
+        if (
+            minDepartureMinutes === null ||
+            maxDepartureCount === null ||
+            showCancelledDepartures === null ||
+            nightStartHour === null ||
+            nightEndHour === null
+        ) {
             return;
         }
         void triggerSettings(
@@ -82,6 +94,8 @@ export function HomeTab() {
                 minDepartureMinutes,
                 maxDepartureCount,
                 showCancelledDepartures,
+                nightStartHour,
+                nightEndHour,
             },
             {
                 onSuccess: () => {
@@ -96,6 +110,8 @@ export function HomeTab() {
                           minDepartureMinutes,
                           maxDepartureCount,
                           showCancelledDepartures,
+                          nightStartHour,
+                          nightEndHour,
                       }
                     : undefined,
             }
@@ -241,6 +257,54 @@ export function HomeTab() {
                             disabled={isSettingsMutating || isSettingsValidating}
                             size="small"
                         />
+                        <TextField
+                            label={`Reduced refreshing at night from hour (${NIGHT_HOUR_MIN.toString()}-${NIGHT_HOUR_MAX.toString()})`}
+                            type="number"
+                            value={nightStartHour ?? ''}
+                            onChange={(e) => {
+                                const value = parseInt(e.target.value);
+                                setNightStartHour(
+                                    Number.isNaN(value)
+                                        ? null
+                                        : Math.min(Math.max(value, NIGHT_HOUR_MIN), NIGHT_HOUR_MAX)
+                                );
+                            }}
+                            slotProps={{
+                                htmlInput: {
+                                    min: NIGHT_HOUR_MIN,
+                                    max: NIGHT_HOUR_MAX,
+                                    step: 1,
+                                    required: true,
+                                },
+                            }}
+                            sx={{ maxWidth: 360 }}
+                            disabled={isSettingsMutating || isSettingsValidating}
+                            size="small"
+                        />
+                        <TextField
+                            label={`Reduced refreshing at night until hour (${NIGHT_HOUR_MIN.toString()}-${NIGHT_HOUR_MAX.toString()})`}
+                            type="number"
+                            value={nightEndHour ?? ''}
+                            onChange={(e) => {
+                                const value = parseInt(e.target.value);
+                                setNightEndHour(
+                                    Number.isNaN(value)
+                                        ? null
+                                        : Math.min(Math.max(value, NIGHT_HOUR_MIN), NIGHT_HOUR_MAX)
+                                );
+                            }}
+                            slotProps={{
+                                htmlInput: {
+                                    min: NIGHT_HOUR_MIN,
+                                    max: NIGHT_HOUR_MAX,
+                                    step: 1,
+                                    required: true,
+                                },
+                            }}
+                            sx={{ maxWidth: 360 }}
+                            disabled={isSettingsMutating || isSettingsValidating}
+                            size="small"
+                        />
                         <FormControlLabel
                             control={
                                 <Switch
@@ -260,7 +324,9 @@ export function HomeTab() {
                                 isSettingsMutating ||
                                 isSettingsValidating ||
                                 minDepartureMinutes === null ||
-                                maxDepartureCount === null
+                                maxDepartureCount === null ||
+                                nightStartHour === null ||
+                                nightEndHour === null
                             }
                             sx={{ alignSelf: 'flex-start', minWidth: 100 }}>
                             Save Settings
@@ -31,6 +31,14 @@ import {
     SysInfoTaskResponse,
     SysInfoAppStateResponse,
     SysInfoDebugResponse,
+    SysInfoRefreshResponse,
+    SysInfoStringPoolResponse,
+    SysInfoRowPoolResponse,
+    SysInfoRenderResponse,
+    SysInfoSchedulerResponse,
+    SysInfoUiLockResponse,
+    SysInfoCpuWindowResponse,
+    SysInfoAllocationScopeResponse,
 } from '../../api/Responses';
 import { getRequestSender } from '../../util/Ajax';
 import { SYS_INFO_REFRESH_INTERVAL } from '../../util/Constants';
@@ -68,6 +76,37 @@ const KEY_TO_LABEL: Record<string, string> = {
     mac_address: 'MAC address',
     chip_model: 'Chip model',
     bvg_api_url: 'BVG API URL',
+    cycles: 'Refresh cycles',
+    failed_cycles: 'Failed refresh cycles',
+    skipped_cycles: 'Skipped refresh cycles (departures unchanged)',
+    not_modified_responses: 'Not modified responses',
+    interval_ms: 'Next refresh in',
+    interval_reason: 'Reason for the refresh interval',
+    boot_snapshot: 'Last departures at boot (only after software resets)',
+    size: 'Interned strings',
+    capacity: 'Capacity',
+    hits: 'Hits',
+    misses: 'Misses',
+    evictions: 'Evictions',
+    failures: 'Failures (pool full)',
+    hit_rate: 'Hit rate',
+    in_use: 'Rows in use',
+    heap_bytes: 'Heap taken by the rows',
+    last_refresh_invalidated_pixels: 'Pixels redrawn by the last refresh',
+    frames: 'Frames drawn',
+    last_frame_us: 'Last frame (render and flush)',
+    last_full_redraw_us: 'Last full screen redraw',
+    acquisitions: 'UI lock acquisitions',
+    slow_acquisitions: 'Waited longer than 1 ms',
+    total_wait_us: 'Average wait',
+    max_wait_us: 'Longest wait',
+};
+
+const JOB_TO_LABEL: Record<string, string> = {
+    board_poll: 'Apply departures',
+    countdowns: 'Countdowns',
+    last_updated: '"Last updated" label',
+    departures_refresh: 'Fetch departures',
 };
 
 const bottomMarginStyle = css`
@@ -139,6 +178,269 @@ const MemoryTable = ({ data }: { data: SysInfoMemoryResponse }) => (
     </TableContainer>
 );
 
+const RefreshTable = ({ data }: { data: SysInfoRefreshResponse }) => (
+    <TableContainer component={Paper} css={bottomMarginStyle}>
+        <Table>
+            <TableBody>
+                {(
+                    [
+                        'cycles',
+                        'failed_cycles',
+                        'skipped_cycles',
+                        'not_modified_responses',
+                        'interval_ms',
+                        'interval_reason',
+                        'boot_snapshot',
+                    ] satisfies Array<keyof SysInfoRefreshResponse>
+                ).map((key) => (
+                    <TableRow key={key} css={lastTableRowStyle}>
+                        <TableCell component="th" scope="row">
+                            {KEY_TO_LABEL[key] || key}
+                        </TableCell>
+                        <TableCell align="right">
+                            {key === 'interval_ms' ? `${(data[key] / 1000).toFixed(1)} s` : data[key]}
+                        </TableCell>
+                    </TableRow>
+                ))}
+            </TableBody>
+        </Table>
+    </TableContainer>
+);
+
+const StringPoolTable = ({ data }: { data: SysInfoStringPoolResponse }) => (
+    <TableContainer component={Paper} css={bottomMarginStyle}>
+        <Table>
+            <TableBody>
+                {(
+                    ['size', 'capacity', 'hits', 'misses', 'evictions', 'failures', 'hit_rate'] satisfies Array<
+                        keyof SysInfoStringPoolResponse
+                    >
+                ).map((key) => (
+                    <TableRow key={key} css={lastTableRowStyle}>
+                        <TableCell component="th" scope="row">
+                            {KEY_TO_LABEL[key] || key}
+                        </TableCell>
+                        <TableCell align="right">
+                            {key === 'hit_rate' ? `${(data[key] * 100).toFixed(1)} %` : data[key]}
+                        </TableCell>
+                    </TableRow>
+                ))}
+            </TableBody>
+        </Table>
+    </TableContainer>
+);
+
+const RowPoolTable = ({ data }: { data: SysInfoRowPoolResponse }) => (
+    <TableContainer component={Paper} css={bottomMarginStyle}>
+        <Table>
+            <TableBody>
+                {(
+                    ['capacity', 'in_use', 'hits', 'misses', 'heap_bytes'] satisfies Array<keyof SysInfoRowPoolResponse>
+                ).map((key) => (
+                    <TableRow key={key} css={lastTableRowStyle}>
+                        <TableCell component="th" scope="row">
+                            {KEY_TO_LABEL[key] || key}
+                        </TableCell>
+                        <TableCell align="right">
+                            {key === 'heap_bytes' ? `${data[key].toString()} bytes` : data[key]}
+                        </TableCell>
+                    </TableRow>
+                ))}
+            </TableBody>
+        </Table>
+    </TableContainer>
+);
+
+const screenShare = (data: SysInfoRenderResponse) =>
+    data.screen_pixels === 0 ? '0' : ((data.last_refresh_invalidated_pixels / data.screen_pixels) * 100).toFixed(1);
+
+const RenderTable = ({ data }: { data: SysInfoRenderResponse }) => (
+    <TableContainer component={Paper} css={bottomMarginStyle}>
+        <Table>
+            <TableBody>
+                <TableRow key={'last_refresh_invalidated_pixels'} css={lastTableRowStyle}>
+                    <TableCell component="th" scope="row">
+                        {KEY_TO_LABEL.last_refresh_invalidated_pixels}
+                    </TableCell>
+                    <TableCell align="right">
+                        {`${data.last_refresh_invalidated_pixels.toString()} (${screenShare(data)} % of the screen)`}
+                    </TableCell>
+                </TableRow>
+                {(
+                    ['frames', 'last_frame_us', 'last_full_redraw_us'] satisfies Array<keyof SysInfoRenderResponse>
+                ).map((key) => (
+                    <TableRow key={key} css={lastTableRowStyle}>
+                        <TableCell component="th" scope="row">
+                            {KEY_TO_LABEL[key] || key}
+                        </TableCell>
+                        <TableCell align="right">
+                            {key === 'frames' ? data[key] : `${(data[key] / 1000).toFixed(1)} ms`}
+                        </TableCell>
+                    </TableRow>
+                ))}
+            </TableBody>
+        </Table>
+    </TableContainer>
+);
+
+const formatMicroseconds = (us: number) => `${(us / 1000).toFixed(1)} ms`;
+
+const uiLockValue = (data: SysInfoUiLockResponse, key: keyof SysInfoUiLockResponse) => {
+    switch (key) {
+        case 'total_wait_us':
+            return formatMicroseconds(data.acquisitions === 0 ? 0 : data.total_wait_us / data.acquisitions);
+        case 'max_wait_us':
+            return formatMicroseconds(data.max_wait_us);
+        default:
+            return data[key];
+    }
+};
+
+const SchedulerTable = ({ data }: { data: SysInfoSchedulerResponse }) => (
+    <>
+        <TableContainer component={Paper} css={bottomMarginStyle}>
+            <Table>
+                <TableHead>
+                    <TableRow>
+                        <TableCell>Job</TableCell>
+                        <TableCell align="right">Runs</TableCell>
+                        <TableCell align="right">Last lateness</TableCell>
+                        <TableCell align="right">Max lateness</TableCell>
+                        <TableCell align="right">Jitter</TableCell>
+                    </TableRow>
+                </TableHead>
+                <TableBody>
+                    {data.jobs.map((job) => (
+                        <TableRow key={job.name} css={lastTableRowStyle}>
+                            <TableCell component="th" scope="row">
+                                {JOB_TO_LABEL[job.name] || job.name}
+                            </TableCell>
+                            <TableCell align="right">{job.runs}</TableCell>
+                            <TableCell align="right">{formatMicroseconds(job.last_lateness_us)}</TableCell>
+                            <TableCell align="right">{formatMicroseconds(job.max_lateness_us)}</TableCell>
+                            <TableCell align="right">{formatMicroseconds(job.jitter_us)}</TableCell>
+                        </TableRow>
+                    ))}
+                </TableBody>
+            </Table>
+        </TableContainer>
+        <TableContainer component={Paper} css={bottomMarginStyle}>
+            <Table>
+                <TableBody>
+                    {(
+                        ['acquisitions', 'slow_acquisitions', 'total_wait_us', 'max_wait_us'] satisfies Array<
+                            keyof SysInfoUiLockResponse
+                        >
+                    ).map((key) => (
+                        <TableRow key={key} css={lastTableRowStyle}>
+                            <TableCell component="th" scope="row">
+                                {KEY_TO_LABEL[key] || key}
+                            </TableCell>
+                            <TableCell align="right">{uiLockValue(data.ui_lock, key)}</TableCell>
+                        </TableRow>
+                    ))}
+                </TableBody>
+            </Table>
+        </TableContainer>
+    </>
+);
+
+const CPU_TASK_TO_LABEL: Record<keyof SysInfoCpuWindowResponse['tasks'], string> = {
+    lvgl: 'LVGL',
+    httpd: 'Web server',
+    refresher: 'Departures refresher',
+    wifi: 'Wi-Fi',
+    tcpip: 'TCP/IP',
+};
+
+const CpuTable = ({ data }: { data: Array<SysInfoCpuWindowResponse> }) => (
+    <TableContainer component={Paper} css={bottomMarginStyle}>
+        <Table>
+            <TableHead>
+                <TableRow>
+                    <TableCell />
+                    {data.map((window) => (
+                        <TableCell key={window.window_s} align="right">
+                            Last {window.window_s} s
+                        </TableCell>
+                    ))}
+                </TableRow>
+            </TableHead>
+            <TableBody>
+                {data[0].cores.map((_, core) => (
+                    <TableRow key={`core-${core.toString()}`} css={lastTableRowStyle}>
+                        <TableCell component="th" scope="row">
+                            Core {core}
+                        </TableCell>
+                        {data.map((window) => (
+                            <TableCell key={window.window_s} align="right">
+                                {window.cores[core].toFixed(1)} %
+                            </TableCell>
+                        ))}
+                    </TableRow>
+                ))}
+                {R.keys(CPU_TASK_TO_LABEL).map((task) => (
+                    <TableRow key={task} css={lastTableRowStyle}>
+                        <TableCell component="th" scope="row">
+                            {CPU_TASK_TO_LABEL[task]}
+                        </TableCell>
+                        {data.map((window) => (
+                            <TableCell key={window.window_s} align="right">
+                                {window.tasks[task].toFixed(1)} %
+                            </TableCell>
+                        ))}
+                    </TableRow>
+                ))}
+            </TableBody>
+        </Table>
+    </TableContainer>
+);
+
+const ALLOCATION_SCOPE_TO_LABEL: Record<SysInfoAllocationScopeResponse['scope'], string> = {
+    fetch: 'Fetch and parse (HTTP client included)',
+    filter: 'Filter and build board',
+    apply: 'Apply to the screen',
+    cycle: 'Whole refresh cycle (HTTP client included)',
+};
+
+// The HTTP client allocates for every request, so only these scopes can get by without allocating
+const ALLOCATION_FREE_SCOPES: Array<SysInfoAllocationScopeResponse['scope']> = ['filter', 'apply'];
+
+const AllocationTable = ({ data }: { data: Array<SysInfoAllocationScopeResponse> }) => (
+    <TableContainer component={Paper} css={bottomMarginStyle}>
+        <Table>
+            <TableHead>
+                <TableRow>
+                    <TableCell>Scope</TableCell>
+                    <TableCell align="right">Last allocations</TableCell>
+                    <TableCell align="right">Last frees</TableCell>
+                    <TableCell align="right">Last bytes</TableCell>
+                    <TableCell align="right">Max allocations</TableCell>
+                    <TableCell align="right">Allocation-free runs</TableCell>
+                </TableRow>
+            </TableHead>
+            <TableBody>
+                {data.map((scope) => (
+                    <TableRow key={scope.scope} css={lastTableRowStyle}>
+                        <TableCell component="th" scope="row">
+                            {ALLOCATION_SCOPE_TO_LABEL[scope.scope] || scope.scope}
+                        </TableCell>
+                        <TableCell align="right">{scope.last_allocations}</TableCell>
+                        <TableCell align="right">{scope.last_frees}</TableCell>
+                        <TableCell align="right">{scope.last_bytes}</TableCell>
+                        <TableCell align="right">{scope.max_allocations}</TableCell>
+                        <TableCell align="right">
+                            {ALLOCATION_FREE_SCOPES.includes(scope.scope)
+                                ? `${scope.allocation_free_runs.toString()} of ${scope.runs.toString()}`
+                                : '-'}
+                        </TableCell>
+                    </TableRow>
+                ))}
+            </TableBody>
+        </Table>
+    </TableContainer>
+);
+
 const HardwareTable = ({ data }: { data: SysInfoHardwareResponse }) => (
     // TODO Maybe use small variant of the table when there's little space?
     <TableContainer component={Paper} css={bottomMarginStyle}>
@@ -271,6 +573,38 @@ export const SystemInformationTab = () => {
                 Memory
             </Typography>
             <MemoryTable data={data.memory} />
+            <Typography variant="h4" gutterBottom>
+                Departures refresh
+            </Typography>
+            <RefreshTable data={data.refresh} />
+            <Typography variant="h4" gutterBottom>
+                String pool
+            </Typography>
+            <StringPoolTable data={data.string_pool} />
+            <Typography variant="h4" gutterBottom>
+                Departure rows
+            </Typography>
+            <RowPoolTable data={data.row_pool} />
+            <Typography variant="h4" gutterBottom>
+                Display
+            </Typography>
+            <RenderTable data={data.render} />
+            <Typography variant="h4" gutterBottom>
+                Scheduling
+            </Typography>
+            <SchedulerTable data={data.scheduler} />
+            <Typography variant="h4" gutterBottom>
+                CPU usage
+            </Typography>
+            {data.cpu ? <CpuTable data={data.cpu} /> : <p>CPU sampler disabled.</p>}
+            <Typography variant="h4" gutterBottom>
+                Heap allocations per refresh
+            </Typography>
+            {data.allocations ? (
+                <AllocationTable data={data.allocations} />
+            ) : (
+                <p>Allocation tracking disabled, see CONFIG_ALLOC_TRACKING.</p>
+            )}
             <Typography variant="h4" gutterBottom>
                 Hardware
             </Typography>
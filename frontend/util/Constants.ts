@@ -6,3 +6,5 @@ export const MIN_DEPARTURE_MINUTES_MIN = 0;
 export const MIN_DEPARTURE_MINUTES_MAX = 30;
 export const MAX_DEPARTURE_COUNT_MIN = 1;
 export const MAX_DEPARTURE_COUNT_MAX = 20;
+export const NIGHT_HOUR_MIN = 0;
+export const NIGHT_HOUR_MAX = 23;
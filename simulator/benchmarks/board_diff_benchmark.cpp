@@ -0,0 +1,241 @@
+// Reports how many LVGL operations `BoardDiff` produces for typical refresh sequences, compared to the previous
+// approach of updating and re-positioning every row, and checks that applying them really yields the next board.
+// Run with `pio run -e benchmark_board_diff -t exec`.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "board_diff.hpp"
+
+using namespace std;
+using namespace std::chrono_literals;
+
+// Stands in for the children of the departures panel, with the semantics of `lv_obj_move_to_index`
+class ChildList {
+  public:
+    vector<uint64_t> children;
+
+    void moveToIndex(size_t from, size_t to) {
+        const auto child = children[from];
+        children.erase(children.begin() + from);
+        children.insert(children.begin() + to, child);
+    }
+
+    // Same as `moveBefore` in ui.cpp
+    void moveBefore(uint64_t child, const uint64_t *before) {
+        const auto index = indexOf(child);
+        if (before == nullptr) {
+            moveToIndex(index, children.size() - 1);
+            return;
+        }
+        const auto before_index = indexOf(*before);
+        moveToIndex(index, index < before_index ? before_index - 1 : before_index);
+    }
+
+    size_t indexOf(uint64_t child) const {
+        return static_cast<size_t>(find(children.begin(), children.end(), child) - children.begin());
+    }
+};
+
+struct Counts {
+    size_t removed = 0;
+    size_t updated = 0;
+    size_t inserted = 0;
+    size_t moved = 0;
+
+    size_t total() const { return removed + updated + inserted + moved; }
+};
+
+// Applies the diff the way `DeparturesScreen::applyBoard` does, returns false if the result doesn't match `next`
+static bool apply(const BoardDiff &diff, const Board &previous, const Board &next, ChildList &list) {
+    for (const auto &operation : diff) {
+        const uint64_t id = operation.kind == BoardOperation::Kind::Remove ? previous.rows[operation.row].trip_hash
+                                                                           : next.rows[operation.row].trip_hash;
+        const uint64_t before = operation.before == BoardOperation::END ? 0 : next.rows[operation.before].trip_hash;
+        switch (operation.kind) {
+        case BoardOperation::Kind::Remove:
+            list.children.erase(list.children.begin() + list.indexOf(id));
+            break;
+        case BoardOperation::Kind::Update:
+            break;
+        case BoardOperation::Kind::Insert:
+            list.children.push_back(id);
+            list.moveBefore(id, operation.before == BoardOperation::END ? nullptr : &before);
+            break;
+        case BoardOperation::Kind::Move:
+            list.moveBefore(id, operation.before == BoardOperation::END ? nullptr : &before);
+            break;
+        }
+    }
+
+    if (list.children.size() != next.row_count) {
+        return false;
+    }
+    for (size_t i = 0; i < next.row_count; i++) {
+        if (list.children[i] != next.rows[i].trip_hash) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// What the previous `applyBoard` did: remove stale rows, then update and move every row of the next board
+static Counts previousApproach(const Board &previous, const Board &next) {
+    Counts counts;
+    for (size_t i = 0; i < previous.row_count; i++) {
+        if (next.findRow(previous.rows[i].trip_hash) == nullptr) {
+            counts.removed++;
+        }
+    }
+    for (size_t i = 0; i < next.row_count; i++) {
+        if (previous.findRow(next.rows[i].trip_hash) == nullptr) {
+            counts.inserted++;
+        } else {
+            counts.updated++;
+        }
+        counts.moved++;
+    }
+    return counts;
+}
+
+struct Departure {
+    int trip;
+    int minutes;
+};
+
+static const auto BASE_TIME = chrono::system_clock::time_point(1736838000s);
+
+static void fill(Board &board, vector<Departure> departures) {
+    stable_sort(departures.begin(), departures.end(),
+                [](const Departure &a, const Departure &b) { return a.minutes < b.minutes; });
+    board.clear();
+    for (const auto &departure : departures) {
+        const auto id = "1|" + to_string(10000 + departure.trip) + "|0|86|14012025";
+        board.addRow(id, "M" + to_string(departure.trip % 10), "S+U Alexanderplatz Bhf/Memhardstr.",
+                     BASE_TIME + chrono::minutes(departure.minutes), Product::Tram, false);
+    }
+}
+
+static constexpr int REFRESHES = 1000;
+static constexpr int ROWS = 12;
+
+// Runs a sequence of refreshes, `step` turns the departures of one refresh into those of the next one
+static bool run(const char *name, vector<Departure> departures, const function<void(vector<Departure> &)> &step) {
+    Board previous;
+    Board next;
+    BoardDiff diff;
+    ChildList list;
+    Counts counts;
+    Counts previous_counts;
+    bool ok = true;
+    chrono::nanoseconds elapsed{0};
+
+    fill(previous, departures);
+    for (size_t i = 0; i < previous.row_count; i++) {
+        list.children.push_back(previous.rows[i].trip_hash);
+    }
+
+    for (int refresh = 0; refresh < REFRESHES; refresh++) {
+        step(departures);
+        fill(next, departures);
+
+        const auto start = chrono::steady_clock::now();
+        diff.compute(previous, next);
+        elapsed += chrono::steady_clock::now() - start;
+
+        counts.removed += diff.count(BoardOperation::Kind::Remove);
+        counts.updated += diff.count(BoardOperation::Kind::Update);
+        counts.inserted += diff.count(BoardOperation::Kind::Insert);
+        counts.moved += diff.count(BoardOperation::Kind::Move);
+        const auto before = previousApproach(previous, next);
+        previous_counts.removed += before.removed;
+        previous_counts.updated += before.updated;
+        previous_counts.inserted += before.inserted;
+        previous_counts.moved += before.moved;
+
+        ok = apply(diff, previous, next, list) && ok;
+        previous = next;
+    }
+
+    printf("%-22s %6.2f %6.2f %6.2f %6.2f | %6.2f %6.2f | %7.1f ns  %s\n", name,
+           static_cast<double>(counts.removed) / REFRESHES, static_cast<double>(counts.updated) / REFRESHES,
+           static_cast<double>(counts.inserted) / REFRESHES, static_cast<double>(counts.moved) / REFRESHES,
+           static_cast<double>(counts.total()) / REFRESHES, static_cast<double>(previous_counts.total()) / REFRESHES,
+           static_cast<double>(elapsed.count()) / REFRESHES, ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+int main(void) {
+    mt19937 random(42);
+    vector<Departure> initial;
+    for (int i = 0; i < ROWS; i++) {
+        initial.push_back({.trip = i, .minutes = i * 2});
+    }
+    int next_trip = ROWS;
+
+    printf("Operations per refresh, %d refreshes of %d rows\n\n", REFRESHES, ROWS);
+    printf("%-22s %6s %6s %6s %6s | %6s %6s | %10s\n", "", "remove", "update", "insert", "move", "total", "before",
+           "diff time");
+
+    bool ok = true;
+
+    // Nothing changed since the last fetch
+    ok = run("unchanged", initial, [](vector<Departure> &) {}) && ok;
+
+    // The first departure left, a new one shows up at the end
+    ok = run("one departed", initial,
+             [&](vector<Departure> &departures) {
+                 const auto last = departures.back().minutes;
+                 departures.erase(departures.begin());
+                 departures.push_back({.trip = next_trip++, .minutes = last + 2});
+             }) &&
+         ok;
+
+    // Realtime data shifts a couple of departures by a minute, which now and then swaps two of them
+    ok = run("small delays", initial,
+             [&](vector<Departure> &departures) {
+                 for (int i = 0; i < 2; i++) {
+                     auto &departure = departures[random() % departures.size()];
+                     departure.minutes += random() % 2 == 0 ? 1 : 0;
+                 }
+             }) &&
+         ok;
+
+    // One departure is delayed enough to be overtaken by a few others, then back on time
+    ok = run("delay, reordered", initial,
+             [&](vector<Departure> &departures) {
+                 auto &departure = departures[random() % (departures.size() - 3)];
+                 departure.minutes += departure.minutes % 2 == 0 ? 5 : -5;
+             }) &&
+         ok;
+
+    // Another station was configured
+    ok = run("station changed", initial,
+             [&](vector<Departure> &departures) {
+                 for (auto &departure : departures) {
+                     departure.trip = next_trip++;
+                 }
+             }) &&
+         ok;
+
+    // Stress test for the correctness check, anything goes
+    ok = run("random", initial,
+             [&](vector<Departure> &departures) {
+                 departures.clear();
+                 const int count = static_cast<int>(random() % (Board::MAX_ROWS + 1));
+                 for (int i = 0; i < count; i++) {
+                     departures.push_back({.trip = static_cast<int>(random() % 30),
+                                           .minutes = static_cast<int>(random() % 60)});
+                 }
+             }) &&
+         ok;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,101 @@
+// Frame time and memory of the departures board, rendered into a headless display. `departures_screen` either lays
+// out pooled `DepartureItem` rows with flex or draws everything from a single `DepartureTable`, depending on
+// `CONFIG_DEPARTURE_TABLE_WIDGET`, so there's one env per layout. Compare the output of
+// `pio run -e benchmark_departures_flex -t exec` and `pio run -e benchmark_departures_table -t exec`.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "board_fixture.h"
+#include "lvgl.h"
+#include "lvgl_headless.h"
+#include "ui.hpp"
+
+using namespace std;
+using BoardFixture::Departure;
+using BoardFixture::fill;
+
+static constexpr int FRAMES = 500;
+static constexpr int ROWS = 12;
+
+static size_t count_objects(lv_obj_t *object) {
+    size_t count = 1;
+    for (uint32_t i = 0; i < lv_obj_get_child_count(object); i++) {
+        count += count_objects(lv_obj_get_child(object, static_cast<int32_t>(i)));
+    }
+    return count;
+}
+
+// Applies a board per frame, `step` turns the departures of one frame into those of the next one
+static void run(lv_display_t *display, const char *name, vector<Departure> departures,
+                const function<void(vector<Departure> &, int)> &step) {
+    Board board;
+    fill(board, departures);
+    departures_screen.applyBoard(board);
+    lv_refr_now(display);
+
+    chrono::nanoseconds elapsed{0};
+    uint64_t invalidated_pixels = 0;
+    const auto flushed_before = LVGL_Headless::flushed_pixels;
+    for (int frame = 0; frame < FRAMES; frame++) {
+        step(departures, frame);
+        fill(board, departures);
+
+        const auto start = chrono::steady_clock::now();
+        departures_screen.applyBoard(board);
+        lv_refr_now(display);
+        elapsed += chrono::steady_clock::now() - start;
+        invalidated_pixels += render_stats.last_refresh_invalidated_pixels;
+    }
+
+    printf("%-18s %9.1f us %10.0f px %10.0f px\n", name, chrono::duration<double, micro>(elapsed).count() / FRAMES,
+           static_cast<double>(invalidated_pixels) / FRAMES,
+           static_cast<double>(LVGL_Headless::flushed_pixels - flushed_before) / FRAMES);
+}
+
+int main(void) {
+    auto *display = LVGL_Headless::init();
+    UIManager::init();
+
+    const auto initial = BoardFixture::initial(ROWS);
+
+    const auto heap_before_screen = LVGL_Headless::heap_in_use();
+    // Keeps the splash screen, so that freeing it doesn't show up in the numbers
+    departures_screen.switchTo(LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
+    lv_refr_now(display);
+    const auto heap_before_board = LVGL_Headless::heap_in_use();
+    Board board;
+    fill(board, initial);
+    departures_screen.applyBoard(board);
+    lv_refr_now(display);
+    const auto heap_after_board = LVGL_Headless::heap_in_use();
+
+    printf("Layout: %s\n", USE_DEPARTURE_TABLE ? "DepartureTable" : "flex DepartureItem rows");
+    printf("LVGL objects on screen: %d\n", static_cast<int>(count_objects(lv_screen_active())));
+    printf("LVGL heap for the screen: %d bytes, for a board of %d rows: %d bytes\n\n",
+           static_cast<int>(heap_before_board - heap_before_screen), ROWS,
+           static_cast<int>(heap_after_board - heap_before_board));
+    printf("Per frame, %d frames\n", FRAMES);
+    printf("%-18s %12s %13s %13s\n", "", "apply+render", "invalidated", "flushed");
+
+    // Nothing changed since the last fetch
+    run(display, "unchanged", initial, [](vector<Departure> &, int) {});
+
+    // One departure is a minute late, then on time again
+    run(display, "one delayed", initial,
+        [](vector<Departure> &departures, int frame) { BoardFixture::toggle_delay(departures, frame % 2 == 0); });
+
+    // The first departure left, a new one shows up at the end
+    int next_trip = ROWS;
+    run(display, "one departed", initial,
+        [&](vector<Departure> &departures, int) { BoardFixture::depart_first(departures, next_trip); });
+
+    // Raw drawing cost, e.g. when switching screens
+    run(display, "full redraw", initial, [](vector<Departure> &, int) { lv_obj_invalidate(lv_screen_active()); });
+
+    return EXIT_SUCCESS;
+}
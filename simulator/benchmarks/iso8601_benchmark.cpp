@@ -0,0 +1,98 @@
+// Compares `ISO8601::parse` against the strptime/mktime based conversion it replaced.
+// Run with `pio run -e benchmark_iso8601 -t exec`.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "iso8601.hpp"
+
+using namespace std;
+
+using TimePoint = ISO8601::TimePoint;
+
+// Verbatim copy of the previous `Time::iSO8601StringToTimePoint`, minus the logging
+static TimePoint libcISO8601StringToTimePoint(const string &iso8601) {
+    tm t = {};
+    auto result = strptime(iso8601.c_str(), "%FT%T", &t);
+    if (result == nullptr) {
+        return TimePoint();
+    }
+
+    auto now = time(nullptr);
+    auto local_tm = *localtime(&now);
+    auto utc_tm = *gmtime(&now);
+
+    auto local_time = mktime(&local_tm);
+    auto utc_time = mktime(&utc_tm);
+    auto tz_offset = local_time - utc_time;
+
+    auto time = mktime(&t);
+    if (time == -1) {
+        return TimePoint();
+    }
+
+    time -= tz_offset;
+
+    return TimePoint(chrono::seconds(time));
+}
+
+// Same shape as the `when`/`plannedWhen` values of a departures response
+static const vector<const char *> TIMESTAMPS = {
+    "2025-01-14T08:03:00+01:00", "2025-01-14T08:05:00+01:00", "2025-01-14T08:07:00+01:00",
+    "2025-01-14T08:12:00+01:00", "2025-01-14T08:15:00+01:00", "2025-01-14T08:21:00+01:00",
+    "2025-01-14T08:24:00+01:00", "2025-01-14T08:30:00+01:00", "2025-01-14T08:41:00+01:00",
+    "2025-01-14T08:59:00+01:00",
+};
+
+// The API returns the offset valid at each departure, the libc path applies the one valid "now".
+// Depending on the date the benchmark runs on, either the winter or the summer timestamps come out wrong.
+static const vector<const char *> OFFSET_TIMESTAMPS = {
+    "2025-01-14T08:03:00+01:00",
+    "2025-07-14T08:03:00+02:00",
+    "2025-03-30T01:55:00+01:00",
+    "2025-03-30T03:05:00+02:00",
+    "2025-10-26T02:55:00+02:00",
+    "2025-10-26T02:05:00+01:00",
+};
+
+static constexpr int ITERATIONS = 200000;
+
+template <typename F> static double nanosecondsPerCall(F &&parse) {
+    long long checksum = 0;
+    const auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        checksum += parse(TIMESTAMPS[i % TIMESTAMPS.size()]).time_since_epoch().count();
+    }
+    const auto elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start);
+    // Keep the compiler from optimizing the loop away
+    if (checksum == 42) {
+        printf("\n");
+    }
+    return elapsed.count() / ITERATIONS;
+}
+
+int main(void) {
+    // Same TZ as configured in `Time::initSNTP`
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+
+    const auto libc_ns = nanosecondsPerCall([](const char *timestamp) { return libcISO8601StringToTimePoint(timestamp); });
+    const auto iso8601_ns = nanosecondsPerCall([](const char *timestamp) { return *ISO8601::parse(timestamp); });
+
+    printf("strptime + mktime: %8.1f ns/call\n", libc_ns);
+    printf("ISO8601::parse:    %8.1f ns/call (%.1fx faster)\n", iso8601_ns, libc_ns / iso8601_ns);
+
+    printf("\nSeconds since epoch:\n");
+    for (const auto *timestamp : OFFSET_TIMESTAMPS) {
+        const auto parsed = ISO8601::parse(timestamp)->time_since_epoch().count();
+        const auto libc = libcISO8601StringToTimePoint(timestamp).time_since_epoch().count();
+        printf("%s  ISO8601::parse: %lld  strptime + mktime: %lld%s\n", timestamp, static_cast<long long>(parsed),
+               static_cast<long long>(libc), parsed == libc ? "" : "  <- differs");
+    }
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+// Drives `departures_screen` through scripted refreshes and touch scrolling on a headless display, and reports per
+// scenario how long LVGL's passes take, how many LVGL objects were created, how much of LVGL's heap is in use and how
+// many allocations applying a board took, C++ and LVGL ones alike. Fails if applying a board whose departures didn't
+// change allocates.
+// Needs neither SDL nor the hardware, so it runs in CI as well. Run with `pio run -e benchmark_render -t exec`, add
+// `-D CONFIG_DEPARTURE_TABLE_WIDGET=1` to the env's build flags to measure `DepartureTable` instead.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <vector>
+
+#include "alloc_tracker.hpp"
+#include "board_fixture.h"
+#include "lvgl.h"
+#include "lvgl_headless.h"
+#include "ui.hpp"
+
+using namespace std;
+
+static uint32_t objects_created = 0;
+
+// Every LVGL object is created through this, the env links with `--wrap=lv_obj_class_create_obj`
+extern "C" {
+lv_obj_t *__real_lv_obj_class_create_obj(const lv_obj_class_t *class_p, lv_obj_t *parent);
+
+lv_obj_t *__wrap_lv_obj_class_create_obj(const lv_obj_class_t *class_p, lv_obj_t *parent) {
+    objects_created++;
+    return __real_lv_obj_class_create_obj(class_p, parent);
+}
+
+// LVGL allocates from its own heap, the env links with `--wrap` for these as well
+void *__real_lv_malloc_core(size_t size);
+void *__real_lv_realloc_core(void *p, size_t new_size);
+void __real_lv_free_core(void *p);
+
+void *__wrap_lv_malloc_core(size_t size) {
+    AllocTracker::recordAllocation(size);
+    return __real_lv_malloc_core(size);
+}
+
+void *__wrap_lv_realloc_core(void *p, size_t new_size) {
+    if (p != nullptr) {
+        AllocTracker::recordFree();
+    }
+    AllocTracker::recordAllocation(new_size);
+    return __real_lv_realloc_core(p, new_size);
+}
+
+void __wrap_lv_free_core(void *p) {
+    if (p != nullptr) {
+        AllocTracker::recordFree();
+    }
+    __real_lv_free_core(p);
+}
+}
+
+// Counts the C++ allocations, like the heap hooks on the device. The array forms call these.
+void *operator new(size_t size) {
+    AllocTracker::recordAllocation(size);
+    if (auto *p = malloc(size)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    if (p != nullptr) {
+        AllocTracker::recordFree();
+    }
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+// One pass of the LVGL task per refresh period, like `lvgl_port` on the device
+static constexpr uint32_t FRAME_MS = LV_DEF_REFR_PERIOD;
+// The refresher publishes a board every few seconds, compressed a lot here
+static constexpr int FRAMES_PER_REFRESH = 10;
+static constexpr int ROWS = 12;
+
+// State of the simulated touch screen, read by LVGL through `lv_indev_set_read_cb`
+static lv_point_t touch_point = {.x = 0, .y = 0};
+static bool touch_pressed = false;
+
+// Hands the departures over to the LVGL task, like the refresher does
+static void publish(const vector<BoardFixture::Departure> &departures) {
+    BoardFixture::fill(board_buffer.back(), departures);
+    board_buffer.publish();
+}
+
+struct FrameTimes {
+    int frames = 0;
+    chrono::nanoseconds total{0};
+    chrono::nanoseconds max{0};
+};
+
+static void run_frame(FrameTimes &times) {
+    LVGL_Headless::advance(FRAME_MS);
+
+    const auto start = chrono::steady_clock::now();
+    {
+        const ui_lock_guard lock;
+        lv_timer_handler();
+    }
+    const auto elapsed = chrono::steady_clock::now() - start;
+    times.frames++;
+    times.total += elapsed;
+    times.max = max<chrono::nanoseconds>(times.max, elapsed);
+}
+
+// Runs `frames` passes of the LVGL task, calling `step` before each one. In a `steady` scenario the departures don't
+// change, so applying a board must not allocate; returns false if it did.
+static bool scenario(const char *name, int frames, const function<void(int)> &step, bool steady = false) {
+    FrameTimes times;
+    const auto objects_before = objects_created;
+    const auto heap_before = LVGL_Headless::heap_in_use();
+    const auto flushed_before = LVGL_Headless::flushed_pixels;
+    const auto &apply_stats = alloc_scope_stats[AllocScopes::index(AllocScope::Apply)];
+    const auto applies_before = apply_stats.runs.load();
+    const auto apply_allocations_before = apply_stats.total_allocations.load();
+    for (int frame = 0; frame < frames; frame++) {
+        step(frame);
+        run_frame(times);
+    }
+    const auto heap_after = LVGL_Headless::heap_in_use();
+
+    // Allocations per applied board, the goal being none when the departures didn't change
+    const auto applies = apply_stats.runs.load() - applies_before;
+    const auto apply_allocations = apply_stats.total_allocations.load() - apply_allocations_before;
+    char allocations_per_apply[16] = "-";
+    if (applies > 0) {
+        snprintf(allocations_per_apply, sizeof(allocations_per_apply), "%.1f",
+                 static_cast<double>(apply_allocations) / applies);
+    }
+    const bool ok = !steady || apply_allocations == 0;
+
+    printf("%-20s %6d %9.1f %9.1f %8d %9d %+9d %10.0f %13s  %s\n", name, times.frames,
+           chrono::duration<double, micro>(times.total).count() / times.frames,
+           chrono::duration<double, micro>(times.max).count(), static_cast<int>(objects_created - objects_before),
+           static_cast<int>(heap_after), static_cast<int>(heap_after) - static_cast<int>(heap_before),
+           static_cast<double>(LVGL_Headless::flushed_pixels - flushed_before) / times.frames, allocations_per_apply,
+           ok ? "" : "ALLOCATES");
+    return ok;
+}
+
+// Drags from `from` by `distance` pixels over `frames` frames, then lifts the finger
+static void drag(int frame, lv_point_t from, int32_t distance, int frames) {
+    if (frame > frames) {
+        return;
+    }
+    touch_pressed = frame < frames;
+    touch_point = {.x = from.x, .y = from.y + distance * frame / frames};
+}
+
+int main(void) {
+    LVGL_Headless::init();
+    auto *touch = lv_indev_create();
+    lv_indev_set_type(touch, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(touch, [](lv_indev_t *, lv_indev_data_t *data) {
+        data->point = touch_point;
+        data->state = touch_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    });
+
+    printf("Layout: %s, %d ms per frame\n\n", USE_DEPARTURE_TABLE ? "DepartureTable" : "flex DepartureItem rows",
+           static_cast<int>(FRAME_MS));
+    printf("%-20s %6s %9s %9s %8s %9s %9s %10s %13s\n", "", "frames", "avg us", "max us", "objects", "heap",
+           "heap diff", "flushed px", "allocs/apply");
+
+    auto departures = BoardFixture::initial(ROWS);
+    int next_trip = ROWS;
+    bool ok = true;
+
+    scenario("startup", 10, [](int frame) {
+        if (frame == 0) {
+            UIManager::init();
+            departures_screen.switchTo();
+            departures_screen.showLoadingMessage("S+U Alexanderplatz");
+        }
+    });
+
+    scenario("first board", 10, [&](int frame) {
+        if (frame == 0) {
+            publish(departures);
+        }
+    });
+
+    // Only the "Last updated" label changes
+    scenario("idle", 60, [](int) {});
+
+    ok = scenario(
+             "refresh, unchanged", 100,
+             [&](int frame) {
+                 if (frame % FRAMES_PER_REFRESH == 0) {
+                     publish(departures);
+                 }
+             },
+             true) &&
+         ok;
+
+    // A departure is a minute late, then on time again
+    scenario("refresh, delayed", 100, [&](int frame) {
+        if (frame % FRAMES_PER_REFRESH == 0) {
+            BoardFixture::toggle_delay(departures, frame % (2 * FRAMES_PER_REFRESH) == 0);
+            publish(departures);
+        }
+    });
+
+    // The first departure left, a new one shows up at the end
+    scenario("refresh, departed", 100, [&](int frame) {
+        if (frame % FRAMES_PER_REFRESH == 0) {
+            BoardFixture::depart_first(departures, next_trip);
+            publish(departures);
+        }
+    });
+
+    // Swipe up through the departures, let the scroll settle, then swipe back down
+    scenario("scroll", 120, [](int frame) {
+        if (frame < 60) {
+            drag(frame, {.x = 240, .y = 260}, -180, 15);
+        } else {
+            drag(frame - 60, {.x = 240, .y = 80}, 180, 15);
+        }
+    });
+
+    scenario("station changed", 30, [&](int frame) {
+        if (frame == 0) {
+            departures_screen.clean();
+            departures_screen.showLoadingMessage("U Hönow");
+        } else if (frame == FRAMES_PER_REFRESH) {
+            for (auto &departure : departures) {
+                departure.trip = next_trip++;
+            }
+            publish(departures);
+        }
+    });
+
+    printf("\nLVGL heap peak: %d bytes\n", static_cast<int>(LVGL_Headless::heap_max_used()));
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
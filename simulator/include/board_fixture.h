@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "board.hpp"
+
+// Departures for the headless benchmarks, shaped like the ones from the BVG API: long trip ids, a mix of products,
+// directions of different lengths and every fifth trip cancelled. The scenarios edit a list of `Departure`s and
+// turn it into a board with `fill`.
+namespace BoardFixture {
+
+struct Departure {
+    int trip;
+    int minutes;
+};
+
+inline const auto BASE_TIME = std::chrono::system_clock::now();
+
+// `count` departures two minutes apart
+inline std::vector<Departure> initial(int count) {
+    std::vector<Departure> departures;
+    for (int i = 0; i < count; i++) {
+        departures.push_back({.trip = i, .minutes = i * 2});
+    }
+    return departures;
+}
+
+inline void fill(Board &board, const std::vector<Departure> &departures) {
+    using namespace std::chrono_literals;
+    static const char *DIRECTIONS[] = {"S+U Alexanderplatz Bhf/Memhardstr.", "U Hönow", "S Hackescher Markt",
+                                       "Prenzlauer Berg, Michelangelostr."};
+    board.clear();
+    board.updated_at = std::chrono::system_clock::now();
+    for (const auto &departure : departures) {
+        const auto id = "1|" + std::to_string(10000 + departure.trip) + "|0|86|14012025";
+        const auto product = Products::fromIndex(static_cast<size_t>(departure.trip) % Products::COUNT);
+        board.addRow(id, "M" + std::to_string(departure.trip % 10), DIRECTIONS[departure.trip % 4],
+                     BASE_TIME + std::chrono::minutes(departure.minutes) + 30s, product, departure.trip % 5 == 0);
+    }
+    board.sortByDepartureTime();
+}
+
+// One departure is a minute late, then on time again on the next call
+inline void toggle_delay(std::vector<Departure> &departures, bool late) { departures[3].minutes += late ? 1 : -1; }
+
+// The first departure left, a new one shows up at the end
+inline void depart_first(std::vector<Departure> &departures, int &next_trip) {
+    const auto last = departures.back().minutes;
+    departures.erase(departures.begin());
+    departures.push_back({.trip = next_trip++, .minutes = last + 2});
+}
+} // namespace BoardFixture
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "lvgl.h"
+
+#define HEADLESS_HOR_RES 480
+#define HEADLESS_VER_RES 320
+// Same as the default `CONFIG_LCD_DRAW_BUFFER_HEIGHT` on the device
+#define HEADLESS_BUFFER_LINES 32
+
+// A display without a window: LVGL renders like on the device, into a draw buffer of the same size and in the same
+// color format, and the result is thrown away. The tick only moves when told to, so that timers, animations and input
+// devices run at the same pace however fast the host is.
+namespace LVGL_Headless {
+
+inline uint32_t tick_ms = 0;
+inline uint64_t flushed_pixels = 0;
+
+inline lv_display_t *init() {
+    lv_init();
+    lv_tick_set_cb([]() { return tick_ms; });
+
+    auto *display = lv_display_create(HEADLESS_HOR_RES, HEADLESS_VER_RES);
+    lv_display_set_color_format(display, LV_COLOR_FORMAT_RGB565_SWAPPED);
+    static std::vector<uint8_t> buffer(HEADLESS_HOR_RES * HEADLESS_BUFFER_LINES * sizeof(uint16_t));
+    lv_display_set_buffers(display, buffer.data(), nullptr, static_cast<uint32_t>(buffer.size()),
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(display, [](lv_display_t *display, const lv_area_t *area, uint8_t *) {
+        flushed_pixels += lv_area_get_size(area);
+        lv_display_flush_ready(display);
+    });
+    return display;
+}
+
+// Lets `ms` milliseconds pass for LVGL
+inline void advance(uint32_t ms) { tick_ms += ms; }
+
+// Bytes taken from LVGL's heap. Only known with `LV_STDLIB_BUILTIN`, which the headless envs use.
+inline size_t heap_in_use() {
+    lv_mem_monitor_t monitor;
+    lv_mem_monitor(&monitor);
+    return monitor.total_size - monitor.free_size;
+}
+
+inline size_t heap_max_used() {
+    lv_mem_monitor_t monitor;
+    lv_mem_monitor(&monitor);
+    return monitor.max_used;
+}
+} // namespace LVGL_Headless
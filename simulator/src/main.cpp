@@ -89,14 +89,6 @@ static void mock_reset_wifi_and_reboot() {
     exit(0);
 }
 
-static int timestamp_refresh_thread(void *data) {
-    while (true) {
-        this_thread::sleep_for(500ms);
-        departures_screen.refreshLastUpdatedDisplay();
-    }
-    return 0;
-}
-
 static int ui_thread(void *data) {
     UIManager::init();
 
@@ -155,41 +147,46 @@ static int ui_thread(void *data) {
 
     departures_screen.clean();
 
-    // Start timestamp refresh thread
-    SDL_CreateThread(timestamp_refresh_thread, "timestamp_refresh", NULL);
-
     // Generate batch of departures like ESP32 does
     uniform_int_distribution<> line_dist(0, BERLIN_LINES.size() - 1);
     uniform_int_distribution<> time_dist(0, 25);
     uniform_int_distribution<> count_dist(8, 15);
     uniform_int_distribution<> cancelled_dist(1, 100); // 1-100 for percentage
 
+    // Like the refresher on the ESP32, build a board and hand it over to the LVGL thread
     auto generateAndUpdateDepartures = [&]() {
+        auto &board = board_buffer.back();
+        board.clear();
+        board.updated_at = chrono::system_clock::now();
+
         int count = count_dist(gen);
         for (int i = 0; i < count; i++) {
             const auto &line_data = BERLIN_LINES[line_dist(gen)];
-            auto departure_time = chrono::minutes(time_dist(gen));
+            auto time_to_departure = chrono::minutes(time_dist(gen));
 
             // Occasionally add "Now" departures
             if (i % 4 == 0) {
-                departure_time = chrono::minutes(0);
+                time_to_departure = chrono::minutes(0);
             }
+            // A bit of slack, otherwise the "Now" departures would be dropped right away as departed
+            const auto departure_time = chrono::system_clock::now() + time_to_departure + 30s;
 
             // Simulate cancelled departures (20% chance)
             bool is_cancelled = cancelled_dist(gen) <= 20;
 
             string trip_id = "sim_trip_" + to_string(i);
-            departures_screen.updateDepartureItem(trip_id, line_data.line, line_data.direction, departure_time,
-                                                  line_data.product, is_cancelled);
+            board.addRow(trip_id, line_data.line, line_data.direction, departure_time,
+                         *Products::fromName(line_data.product), is_cancelled);
         }
+
+        board.sortByDepartureTime();
+        board_buffer.publish();
     };
 
     // Simulate periodic API refreshes (like ESP32 does every 5 seconds)
     while (true) {
         // Generate new batch of departures (simulating new API response)
         generateAndUpdateDepartures();
-        departures_screen.reorderByDepartureTime();
-        departures_screen.updateLastUpdatedTime();
 
         this_thread::sleep_for(5s);
     }